@@ -1,19 +1,17 @@
 #include <numeric>
+#include <algorithm>
+#include <optional>
 #include "Alphabet.h"
+#include "TextureAtlas.h"
 #include "InitLibs.h"
 #include "Device.h"
 #include "CommandPool.h"
-#include "CommandBuffer.h"
 #include "GraphicsPipeline.h"
 #include "DescriptorSetLayout.h"
 #include "VkResultString.h"
 #include "Sampler.h"
 
 namespace VKKit {
-static constexpr std::array<unsigned, 6> indices = {
-    0, 1, 2, 2, 3, 0
-};
-
 static void ThrowFTError(std::string_view error_string, FT_Error code)
 {
     char error[256];
@@ -33,19 +31,17 @@ static constexpr std::string_view GetWord(std::string_view text)
     return text;
 }
 
-static VkDescriptorSet CreateGlyphDescriptor(const Device& device, const DescriptorPool& pool, const DescriptorSetLayout& layout,
-    const Sampler& sampler, const Texture& texture, const Buffer& color_uniform_buffer, const Buffer& projection_uniform_buffer)
+// The set a string is drawn with: the glyph atlas and the projection of one frame in flight
+static VkDescriptorSet CreateTextDescriptor(const Device& device, const DescriptorPool& pool, const DescriptorSetLayout& layout,
+    const Sampler& sampler, const Texture& atlas, const Buffer& projection_uniform_buffer)
 {
-    const std::array<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts {
-        layout.Get(),
-        layout.Get()
-    };
+    const VkDescriptorSetLayout set_layout = layout.Get();
 
     const VkDescriptorSetAllocateInfo alloc_info = {
         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
         .descriptorPool = pool.Get(),
         .descriptorSetCount = 1,
-        .pSetLayouts = layouts.data(),
+        .pSetLayouts = &set_layout,
     };
 
     VkDescriptorSet set{};
@@ -53,41 +49,30 @@ static VkDescriptorSet CreateGlyphDescriptor(const Device& device, const Descrip
     const auto result = vkAllocateDescriptorSets(device.Get(), &alloc_info, &set);
     if (result != VK_SUCCESS) ThrowError("Failed to create descriptor sets.", result);
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-        const VkDescriptorImageInfo face_info = { sampler.Get(), texture.GetView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-        const VkDescriptorBufferInfo color_buffer_info = { color_uniform_buffer.GetBuffer(), 0, sizeof(Color) };
-        const VkDescriptorBufferInfo projection_buffer_info = { projection_uniform_buffer.GetBuffer(), 0, sizeof(glm::mat4) };
-
-        const std::array<VkWriteDescriptorSet, 3> write_sets = {{
-            {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = set,
-                .dstBinding = 0,
-                .dstArrayElement = 0,
-                .descriptorCount = 1,
-                .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-                .pImageInfo = &face_info
-            },
-            {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = set,
-                .dstBinding = 1,
-                .descriptorCount = 1,
-                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                .pBufferInfo = &color_buffer_info
-            },
-            {
-                .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-                .dstSet = set,
-                .dstBinding = 2,
-                .descriptorCount = 1,
-                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-                .pBufferInfo = &projection_buffer_info
-            }
-        }};
+    const VkDescriptorImageInfo face_info = { sampler.Get(), atlas.GetView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+    const VkDescriptorBufferInfo projection_buffer_info = { projection_uniform_buffer.GetBuffer(), 0, sizeof(glm::mat4) };
 
-        vkUpdateDescriptorSets(device.Get(), static_cast<uint32_t>(write_sets.size()), write_sets.data(), 0, nullptr);
-    }
+    const std::array<VkWriteDescriptorSet, 2> write_sets = {{
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = 0,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .pImageInfo = &face_info
+        },
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = 2,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .pBufferInfo = &projection_buffer_info
+        }
+    }};
+
+    vkUpdateDescriptorSets(device.Get(), static_cast<uint32_t>(write_sets.size()), write_sets.data(), 0, nullptr);
 
     return set;
 }
@@ -161,21 +146,43 @@ static size_t GetFontGlyphCount(const Face& face)
     return count;
 }
 
+namespace {
+// The rendered bitmap of a glyph, before it is copied into the atlas
+struct GlyphBitmap {
+    FT_ULong charcode;
+    uint32_t width, rows;
+    std::vector<unsigned char> texels;
+};
+}
+
+// Find a place in a size x size atlas for every bitmap, with GLYPH_PADDING empty texels around each so that filtering doesn't pick up
+// their neighbours. Returns nothing if they don't all fit.
+static std::optional<std::vector<SkylinePacker::Position>> PackGlyphs(std::span<const GlyphBitmap> bitmaps, uint32_t size)
+{
+    static constexpr uint32_t GLYPH_PADDING = 1;
+
+    SkylinePacker packer(size, size);
+    std::vector<SkylinePacker::Position> positions;
+    positions.reserve(bitmaps.size());
+
+    for (const GlyphBitmap& bitmap : bitmaps) {
+        const auto position = packer.Insert(bitmap.width + 2 * GLYPH_PADDING, bitmap.rows + 2 * GLYPH_PADDING);
+        if (!position) return std::nullopt;
+        positions.push_back({ position->x + GLYPH_PADDING, position->y + GLYPH_PADDING });
+    }
+
+    return positions;
+}
+
 Alphabet::Alphabet() noexcept :
-    device{ nullptr },
-    color_uniforms_mapped{},
-    current_buffer_positions{}
+    descriptors{}
 {}
 
 Alphabet::Alphabet(const FreeType& ft, std::string_view font_path, VkPhysicalDevice physical_device, const Device& device,
     const CommandPool& pool, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-    VkSampleCountFlagBits samples) :
-    device{ device.Get() },
-    current_buffer_positions{}
+    VkSampleCountFlagBits samples)
 {
     (void)samples; // Find a use for this or remove it
-    (void)projection_uniforms; // Find a use for this or remove it
-    (void)sampler; // Find a use for this or remove it
 
     const Face face(ft, font_path);
     face.SetPixelSizes(0, static_cast<int>(BASE_FONT_HEIGHT));
@@ -183,59 +190,81 @@ Alphabet::Alphabet(const FreeType& ft, std::string_view font_path, VkPhysicalDev
     const size_t total_glyphs = GetFontGlyphCount(face);
 
     glyphs.reserve(total_glyphs);
-    bitmaps.reserve(total_glyphs);
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-        color_uniforms[i].resize(200 * MAX_FRAMES_IN_FLIGHT); // Quick hack to get uniform buffers working, should be fixed eventually
-        color_uniforms_mapped[i].resize(200 * MAX_FRAMES_IN_FLIGHT);
-        
-        for (size_t j = 0; j < color_uniforms.size(); ++j) {
-            color_uniforms[i][j] = Buffer(physical_device, device.Get(), sizeof(Color), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_SHARING_MODE_EXCLUSIVE);
-        }
-    }
 
-    CreateDescriptorPool(device, layout, total_glyphs);
+    std::vector<GlyphBitmap> bitmaps;
 
     for (FT_ULong charcode = FIRST_PRINTABLE_ASCII; charcode <= LAST_PRINTABLE_ASCII; ++charcode) {
         if (FT_Get_Char_Index(face.Get(), charcode) == 0) continue;
         face.LoadGlyph(charcode);
 
-        const unsigned width = face.GetGlyph()->bitmap.width;
-        const unsigned rows = face.GetGlyph()->bitmap.rows;
+        const FT_Bitmap& bitmap = face.GetGlyph()->bitmap;
+        const unsigned width = bitmap.width;
+        const unsigned rows = bitmap.rows;
         const FT_Int bearingx = face.GetGlyph()->bitmap_left;
         const FT_Int bearingy = face.GetGlyph()->bitmap_top;
         const FT_Pos advancex = face.GetGlyph()->advance.x;
-        const unsigned char* bitmap = face.GetGlyph()->bitmap.buffer;
-        const size_t bitmap_size = width * rows;
 
-        glyphs.insert({ charcode, Glyph { { width, rows }, { bearingx, bearingy }, advancex }});
+        glyphs.insert({ charcode, Glyph { { width, rows }, { bearingx, bearingy }, advancex, Rect{} }});
 
-        if (bitmap_size != 0) {
-            bitmaps.insert({ charcode, Texture(physical_device, device, pool, VK_FORMAT_R8_SRGB, width, rows, { bitmap, bitmap_size },
-                VK_IMAGE_TILING_OPTIMAL, VK_SAMPLE_COUNT_1_BIT, 1) });
-        }
+        if (width == 0 || rows == 0) continue;
+
+        // The rows of a FreeType bitmap may be padded, so they are copied one at a time
+        GlyphBitmap& copy = bitmaps.emplace_back(GlyphBitmap{ charcode, width, rows, std::vector<unsigned char>(width * rows) });
+        for (unsigned row = 0; row < rows; ++row)
+            std::copy_n(bitmap.buffer + static_cast<ptrdiff_t>(row) * bitmap.pitch, width, copy.texels.begin() + row * width);
     }
 
-    //CreateDescriptors(device, layout, sampler, projection_uniforms);
+    // Tallest first keeps the skyline flat, which packs the glyphs tighter
+    std::ranges::sort(bitmaps, [](const GlyphBitmap& a, const GlyphBitmap& b) { return a.rows > b.rows; });
+
+    uint32_t size = MIN_ATLAS_SIZE;
+    auto positions = PackGlyphs(bitmaps, size);
+    for (; !positions; positions = PackGlyphs(bitmaps, size)) {
+        if (size == MAX_ATLAS_SIZE) throw std::runtime_error("The glyphs of the font don't fit in a texture atlas");
+        size *= 2;
+    }
+
+    // Every glyph is copied into one texture, so the font is uploaded at once and a string is drawn from a single descriptor set
+    std::vector<unsigned char> texels(static_cast<size_t>(size) * size, 0);
+
+    for (size_t i = 0; i < bitmaps.size(); ++i) {
+        const GlyphBitmap& bitmap = bitmaps[i];
+        const SkylinePacker::Position position = (*positions)[i];
+
+        for (uint32_t row = 0; row < bitmap.rows; ++row)
+            std::ranges::copy_n(bitmap.texels.begin() + row * bitmap.width, bitmap.width, texels.begin() + (position.y + row) * size + position.x);
+
+        glyphs.at(bitmap.charcode).uv = Rect{
+            static_cast<float>(position.x) / size, static_cast<float>(position.y) / size,
+            static_cast<float>(bitmap.width) / size, static_cast<float>(bitmap.rows) / size
+        };
+    }
+
+    atlas = Texture(physical_device, device, pool, VK_FORMAT_R8_SRGB, size, size, { texels.data(), texels.size() }, VK_IMAGE_TILING_OPTIMAL,
+        VK_SAMPLE_COUNT_1_BIT, 1, MemoryCategory::FONT);
+
+    // The color of a string is a push constant, so neither of the sets changes after this
+    CreateDescriptorPool(device);
+    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        descriptors[i] = CreateTextDescriptor(device, descriptor_pool, layout, sampler, atlas, projection_uniforms[i]);
 }
 
-void Alphabet::RenderTextRel(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-    const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-    uint32_t current_frame, std::string_view text, Color color, float font_size, float x, float y, VkExtent2D swapchain_extent, HorizontalAlignment halign,
+void Alphabet::RenderTextRel(BindCache& binds, RingBuffer& geometry, const SpriteBatch& quads, const GraphicsPipeline& pipeline, uint32_t current_frame, std::string_view text, Color color, float font_size, float x, float y, VkExtent2D swapchain_extent, HorizontalAlignment halign,
     VerticalAlignment valign, float row_width)
 {
-    vertex_buffers[current_frame].reserve(text.size());
-    index_buffers[current_frame].reserve(text.size());
+    LayoutTextRel(text, font_size, x, y, swapchain_extent, halign, valign, row_width);
+    if (vertices.empty()) return;
 
-    color_uniforms[current_frame].emplace_back(physical_device, device.Get(), sizeof(Color), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_SHARING_MODE_EXCLUSIVE);
-    // color_uniforms_mapped[current_frame].emplace_back(color_uniforms[current_frame].back().GetMemory());
-    color_uniforms_mapped[current_frame].push_back(nullptr);
-    vkMapMemory(device.Get(), color_uniforms[current_frame].back().GetMemory(), 0, sizeof(Color), 0, &color_uniforms_mapped[current_frame].back());
-
-    memcpy(color_uniforms_mapped[current_frame].back(), &color, sizeof(Color));
+    // Every glyph of the string is drawn from the atlas with the string's color, in a single draw
+    const auto range = geometry.Push(vertices.data(), vertices.size() * sizeof(float), sizeof(float));
+    DrawText(binds, quads, pipeline, current_frame, range.buffer, range.offset, GetQuadCount(vertices.size()), color);
+}
 
-    vkCmdBindPipeline(command_buffer.GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.GetPipeline());
+const std::vector<float>& Alphabet::LayoutTextRel(std::string_view text, float font_size, float x, float y, VkExtent2D swapchain_extent,
+    HorizontalAlignment halign, VerticalAlignment valign, float row_width)
+{
+    vertices.clear();
+    vertices.reserve(text.size() * 4 * FLOATS_PER_VERTEX);
 
     // The default resolution for relative rendering is 1920x1080, which is when textures are rendered at their normal size.
     // If the screen is a different size than 1920x1080, textures will be scaled up/down
@@ -272,8 +301,7 @@ void Alphabet::RenderTextRel(VkPhysicalDevice physical_device, const Device& dev
         xoffset = 0.0f;
 
         if (width != 0.0f) {
-            index += RenderTextRow(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms, current_frame,
-                { text.data() + index, text.size() - index }, font_size, realx, y + yoffset, row_width) + 1;
+            index += RenderTextRow({ text.data() + index, text.size() - index }, font_size, realx, y + yoffset, row_width) + 1;
 
             yoffset -= font_size;
         }
@@ -286,40 +314,38 @@ void Alphabet::RenderTextRel(VkPhysicalDevice physical_device, const Device& dev
                 continue;
             }
 
-            const auto displacement = RenderWordMultiline(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms,
-                current_frame, word, font_size, realx, y, row_width, halign, valign);
+            const auto displacement = RenderWordMultiline(word, font_size, realx, y, row_width, halign, valign);
 
             xoffset = displacement.first;
             yoffset += displacement.second;
             index += word.size();
         }
     }
+
+    return vertices;
 }
 
-void Alphabet::RenderTextAbs(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-    const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-    uint32_t current_frame, std::string_view text, Color color, float font_size, float x, float y, HorizontalAlignment halign, VerticalAlignment valign,
-    float row_width)
+void Alphabet::DrawText(BindCache& binds, const SpriteBatch& quads, const GraphicsPipeline& pipeline, uint32_t current_frame, VkBuffer buffer,
+    VkDeviceSize offset, uint32_t quad_count, Color color) const
 {
-    RenderTextRel(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms, current_frame, text, color, font_size,
-        x, y, DEFAULT_EXTENT, halign, valign, row_width);
+    binds.BindPipeline(pipeline.GetPipeline());
+    binds.BindDescriptorSet(pipeline.GetLayout(), 0, descriptors[current_frame]);
+    binds.BindVertexBuffer(0, buffer, offset);
+    quads.BindIndices(binds);
+
+    vkCmdPushConstants(binds.Get(), pipeline.GetLayout(), VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(Color), &color);
+
+    SpriteBatch::DrawQuads(binds.Get(), 0, quad_count);
 }
 
-void Alphabet::ClearBuffers(uint32_t current_frame)
+void Alphabet::RenderTextAbs(BindCache& binds, RingBuffer& geometry, const SpriteBatch& quads, const GraphicsPipeline& pipeline, uint32_t current_frame, std::string_view text, Color color, float font_size, float x, float y, HorizontalAlignment halign, VerticalAlignment valign,
+    float row_width)
 {
-    /*vertex_buffers[current_frame].clear();
-    index_buffers[current_frame].clear();*/
-    current_buffer_positions[current_frame] = 0;
-    color_uniforms[current_frame].clear();
-    color_uniforms_mapped[current_frame].clear();
-    if (bitmap_descriptors[current_frame].size() > 0)
-        vkFreeDescriptorSets(device, descriptor_pool.Get(), static_cast<uint32_t>(bitmap_descriptors[current_frame].size()), bitmap_descriptors[current_frame].data());
-    bitmap_descriptors[current_frame].clear();
+    RenderTextRel(binds, geometry, quads, pipeline, current_frame, text, color, font_size,
+        x, y, DEFAULT_EXTENT, halign, valign, row_width);
 }
 
-size_t Alphabet::RenderTextRow(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-    const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-    uint32_t current_frame, std::string_view row, float font_size, float x, float y, float row_width)
+size_t Alphabet::RenderTextRow(std::string_view row, float font_size, float x, float y, float row_width)
 {
     size_t chars_rendered;
 
@@ -335,8 +361,7 @@ size_t Alphabet::RenderTextRow(VkPhysicalDevice physical_device, const Device& d
             const float word_width = GetWordWidth(word, font_size);
 
             if (word_width <= distance_to_row_end) {
-                RenderWord(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms, current_frame, word, font_size,
-                    x + xoffset, y);
+                RenderWord(word, font_size, x + xoffset, y);
                 chars_rendered += word.size() - 1;
                 xoffset += word_width;
             }
@@ -344,8 +369,7 @@ size_t Alphabet::RenderTextRow(VkPhysicalDevice physical_device, const Device& d
                 if (chars_rendered == 0) {
                     // Big multiline word found at the beginning of the row, render only the part of it that fits inside a single row
                     const auto subword = GetRowSubword(row, font_size, row_width);
-                    RenderWord(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms, current_frame, subword,
-                        font_size, x, y);
+                    RenderWord(subword, font_size, x, y);
                     return subword.size() - 1;
                 }
                 else {
@@ -369,18 +393,13 @@ size_t Alphabet::RenderTextRow(VkPhysicalDevice physical_device, const Device& d
     return chars_rendered;
 }
 
-void Alphabet::RenderWord(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-    const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-    uint32_t current_frame, std::string_view word, float font_size, float x, float y)
+void Alphabet::RenderWord(std::string_view word, float font_size, float x, float y)
 {
     float xoffset = 0.0f;
     for (const auto ch : word) {
         const FT_ULong c = static_cast<FT_ULong>(ch);
 
-        /*RenderChar(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms, current_frame, c, font_size,
-            x + xoffset, y);*/
-        RenderCharOpt(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms, current_frame, c, font_size,
-            x + xoffset, y);
+        RenderChar(c, font_size, x + xoffset, y);
 
         const float advance = static_cast<float>(glyphs.at(c).advance / 64) * font_size / BASE_FONT_HEIGHT;
         xoffset += advance;
@@ -389,9 +408,7 @@ void Alphabet::RenderWord(VkPhysicalDevice physical_device, const Device& device
 
 // Renders a word over multiple lines. Returns a pair of two floats, where the first is the horizontal offset after rendering, and the second is the
 // vertical displacement (how much the text has gone up/down) that happened after the rendering.
-std::pair<float, float> Alphabet::RenderWordMultiline(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool,
-    const CommandBuffer& command_buffer, const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler,
-    std::span<const Buffer> projection_uniforms, uint32_t current_frame, std::string_view word, float font_size, float x, float y, float row_width,
+std::pair<float, float> Alphabet::RenderWordMultiline(std::string_view word, float font_size, float x, float y, float row_width,
     HorizontalAlignment halign, VerticalAlignment valign)
 {
     (void)halign; // Find a use for this or remove it
@@ -403,10 +420,7 @@ std::pair<float, float> Alphabet::RenderWordMultiline(VkPhysicalDevice physical_
     for (const auto ch : word) {
         const FT_ULong c = static_cast<FT_ULong>(ch);
 
-        /*RenderChar(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms, current_frame, c, font_size,
-            x + xoffset, y + yoffset);*/
-        RenderCharOpt(physical_device, device, pool, command_buffer, pipeline, layout, sampler, projection_uniforms, current_frame, c, font_size,
-            x + xoffset, y + yoffset);
+        RenderChar(c, font_size, x + xoffset, y + yoffset);
 
         const float advance = static_cast<float>(glyphs.at(c).advance / 64) * font_size / BASE_FONT_HEIGHT;
 
@@ -422,46 +436,7 @@ std::pair<float, float> Alphabet::RenderWordMultiline(VkPhysicalDevice physical_
     return { xoffset, yoffset };
 }
 
-void Alphabet::RenderChar(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-    const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms, uint32_t current_frame, FT_ULong ch, float font_size,
-    float x, float y)
-{
-    const Glyph glyph = glyphs.at(ch);
-
-    // Normalized coordinates
-    const float xpos = x + glyph.bearing.x * font_size / BASE_FONT_HEIGHT;
-    const float ypos = y - (glyph.size.y - glyph.bearing.y) * font_size / BASE_FONT_HEIGHT;
-    const float width = static_cast<float>(glyph.size.x) * font_size / BASE_FONT_HEIGHT;
-    const float height = static_cast<float>(glyph.size.y) * font_size / BASE_FONT_HEIGHT;
-
-    const std::array<float, 16> vertices = {
-        xpos,           ypos,          0.0f, 1.0f, // Top left
-        xpos + width,   ypos,          1.0f, 1.0f, // Top right
-        xpos + width,   ypos + height, 1.0f, 0.0f, // Bottom right
-        xpos,           ypos + height, 0.0f, 0.0f  // Bottom left
-    };
-
-    vertex_buffers[current_frame].push_back(Buffer::CreateVertexBuffer(physical_device, device, pool, vertices));
-    index_buffers[current_frame].push_back(Buffer::CreateIndexBuffer(physical_device, device, pool, indices));
-
-    // Create a new descriptor for every glyph that is rendered and push it back into the array of descriptors.
-    bitmap_descriptors[current_frame].push_back(CreateGlyphDescriptor(device, descriptor_pool, layout, sampler, bitmaps.at(ch), color_uniforms[current_frame].back(),
-        projection_uniforms[current_frame]));
-
-    const auto buf = vertex_buffers[current_frame].back().GetBuffer();
-    const VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(command_buffer.GetBuffer(), 0, 1, &buf, &offset);
-    vkCmdBindIndexBuffer(command_buffer.GetBuffer(), index_buffers[current_frame].back().GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
-    
-    vkCmdBindDescriptorSets(command_buffer.GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.GetLayout(), 0, 1, &bitmap_descriptors[current_frame].back(),
-        0, nullptr);
-    vkCmdDrawIndexed(command_buffer.GetBuffer(), static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-}
-
-// Fix this function: glyphs are rendered with a very tiny font size
-void Alphabet::RenderCharOpt(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-    const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms, uint32_t current_frame, FT_ULong ch, float font_size,
-    float x, float y)
+void Alphabet::RenderChar(FT_ULong ch, float font_size, float x, float y)
 {
     const Glyph glyph = glyphs.at(ch);
 
@@ -471,47 +446,13 @@ void Alphabet::RenderCharOpt(VkPhysicalDevice physical_device, const Device& dev
     const float width = static_cast<float>(glyph.size.x) * font_size / BASE_FONT_HEIGHT;
     const float height = static_cast<float>(glyph.size.y) * font_size / BASE_FONT_HEIGHT;
 
-    const std::array<float, 16> vertices = {
-        xpos,           ypos,          0.0f, 1.0f, // Top left
-        xpos + width,   ypos,          1.0f, 1.0f, // Top right
-        xpos + width,   ypos + height, 1.0f, 0.0f, // Bottom right
-        xpos,           ypos + height, 0.0f, 0.0f  // Bottom left
-    };
-
-    /*vertex_buffers[current_frame].push_back(Buffer::CreateVertexBuffer(physical_device, device, pool, vertices));
-    index_buffers[current_frame].push_back(Buffer::CreateIndexBuffer(physical_device, device, pool, indices));*/
-    auto& bufpos = current_buffer_positions[current_frame];
-    auto& vbufferarr = vertex_buffers[current_frame];
-    auto& vbufferstaging = vertex_staging_buffers[current_frame];
-    auto& ibufferarr = index_buffers[current_frame];
-    auto& ibufferstaging = index_staging_buffers[current_frame];
-
-    if (bufpos >= vbufferarr.size()) {
-        vbufferarr.push_back(Buffer::CreateVertexBuffer(physical_device, device, pool, vertices));
-        vbufferstaging.push_back(CreateStagingBuffer(physical_device, device.Get(), sizeof(vertices)));
-        ibufferarr.push_back(Buffer::CreateIndexBuffer(physical_device, device, pool, indices));
-        ibufferstaging.push_back(CreateStagingBuffer(physical_device, device.Get(), sizeof(indices)));
-    }
-    else {
-        vbufferarr[bufpos].WriteData(device, pool, vbufferstaging[bufpos], vertices.data(), sizeof(vertices));
-        ibufferarr[bufpos].WriteData(device, pool, ibufferstaging[bufpos], indices.data(), sizeof(indices));
-    }
-
-    // Create a new descriptor for every glyph that is rendered and push it back into the array of descriptors.
-    bitmap_descriptors[current_frame].push_back(CreateGlyphDescriptor(device, descriptor_pool, layout, sampler, bitmaps.at(ch), color_uniforms[current_frame].back(),
-        projection_uniforms[current_frame]));
-
-    //const auto buf = vertex_buffers[current_frame].back().GetBuffer();
-    const auto buf = vbufferarr[bufpos].GetBuffer();
-    const VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(command_buffer.GetBuffer(), 0, 1, &buf, &offset);
-    //vkCmdBindIndexBuffer(command_buffer.GetBuffer(), index_buffers[current_frame].back().GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
-    vkCmdBindIndexBuffer(command_buffer.GetBuffer(), ibufferarr[bufpos].GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
-
-    vkCmdBindDescriptorSets(command_buffer.GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.GetLayout(), 0, 1, &bitmap_descriptors[current_frame].back(),
-        0, nullptr);
-    vkCmdDrawIndexed(command_buffer.GetBuffer(), static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-    ++bufpos;
+    const Rect& uv = glyph.uv;
+    vertices.insert(vertices.end(), {
+        xpos,           ypos,          uv.x,        uv.y + uv.h, // Top left
+        xpos + width,   ypos,          uv.x + uv.w, uv.y + uv.h, // Top right
+        xpos + width,   ypos + height, uv.x + uv.w, uv.y,        // Bottom right
+        xpos,           ypos + height, uv.x,        uv.y         // Bottom left
+    });
 }
 
 float Alphabet::GetWordWidth(std::string_view word, float font_size)
@@ -618,92 +559,20 @@ float Alphabet::GetRowWidth(std::string_view text, float font_size, float row_wi
     return width;
 }
 
-void Alphabet::CreateDescriptorPool(const Device& device, const DescriptorSetLayout& layout, size_t total_glyphs)
+void Alphabet::CreateDescriptorPool(const Device& device)
 {
-    (void)layout; // Find a use for this or remove it
-    const std::array<VkDescriptorPoolSize, 1> pool_sizes = {{
+    // One set per frame in flight, each with the atlas and the projection
+    const std::array<VkDescriptorPoolSize, 2> pool_sizes = {{
         {
             .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-            .descriptorCount = static_cast<uint32_t>(total_glyphs * MAX_FRAMES_IN_FLIGHT) * 100 // TO DO: Pick a more reasonable amount of descriptors
+            .descriptorCount = MAX_FRAMES_IN_FLIGHT
+        },
+        {
+            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorCount = MAX_FRAMES_IN_FLIGHT
         }
     }};
 
-    this->descriptor_pool = DescriptorPool(device, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT, pool_sizes, MAX_FRAMES_IN_FLIGHT);
+    this->descriptor_pool = DescriptorPool(device, VkDescriptorPoolCreateFlags{}, pool_sizes, MAX_FRAMES_IN_FLIGHT);
 }
-
-// void Alphabet::CreateDescriptors(const Device& device, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms)
-// {
-//     AllocateDescriptors(device, layout, sampler);
-    
-//     for (const auto& bitmap : bitmaps) {
-//         const auto& descriptors = bitmap_descriptors.at(bitmap.first);
-
-//         const VkDescriptorImageInfo image_info = { sampler.Get(), bitmap.second.GetView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
-
-//         for (size_t c = 0; c < color_uniforms.size(); ++c) {
-//             for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-//                 const VkDescriptorBufferInfo color_buffer_info = { color_uniforms[i][c].GetBuffer(), 0, sizeof(Color) };
-//                 const VkDescriptorBufferInfo projection_buffer_info = { projection_uniforms[i].GetBuffer(), 0, sizeof(glm::mat4) };
-
-//                 /* Idea for solution: Every time a text rendering call is made, generate new descriptor sets with the desired color */
-//                 const std::array<VkWriteDescriptorSet, 3> descriptor_writes = {{
-//                     {
-//                         .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-//                         .dstSet = descriptors[i],
-//                         .dstBinding = 0,
-//                         .descriptorCount = 1,
-//                         .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
-//                         .pImageInfo = &image_info
-//                     },
-//                     {
-//                         .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-//                         .dstSet = descriptors[i],
-//                         .dstBinding = 1,
-//                         .descriptorCount = 1,
-//                         .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-//                         .pBufferInfo = &color_buffer_info
-//                     },
-//                     {
-//                         .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-//                         .dstSet = descriptors[i],
-//                         .dstBinding = 2,
-//                         .descriptorCount = 1,
-//                         .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-//                         .pBufferInfo = &projection_buffer_info
-//                     }
-//                 }};
-
-//                 vkUpdateDescriptorSets(device.Get(), descriptor_writes.size(), descriptor_writes.data(), 0, nullptr);
-//             }
-//         }
-//     }
-// }
-
-// void Alphabet::AllocateDescriptors(const Device& device, const DescriptorSetLayout& layout, const Sampler& sampler)
-// {
-//     const std::vector<VkDescriptorSetLayout> layouts(bitmaps.size() * MAX_FRAMES_IN_FLIGHT, layout.Get());
-
-//     const VkDescriptorSetAllocateInfo alloc_info = {
-//         .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
-//         .descriptorPool = descriptor_pool.Get(),
-//         .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
-//         .pSetLayouts = layouts.data()
-//     };
-
-//     bitmap_descriptors.reserve(bitmaps.size() * MAX_FRAMES_IN_FLIGHT);
-
-//     std::vector<VkDescriptorSet> descriptors_temp(bitmaps.size() * MAX_FRAMES_IN_FLIGHT);
-//     const auto alloc_result = vkAllocateDescriptorSets(device.Get(), &alloc_info, descriptors_temp.data());
-//     if (alloc_result != VK_SUCCESS) ThrowError("Failed to allocate descriptors for alphabet.", alloc_result);
-
-//     size_t current_descriptor_pair = 0;
-//     for (const auto& bitmap : bitmaps) {
-//         std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptors_to_add;
-//         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
-//             descriptors_to_add[i] = descriptors_temp[i + current_descriptor_pair];
-//         current_descriptor_pair += MAX_FRAMES_IN_FLIGHT;
-
-//         bitmap_descriptors.insert({ bitmap.first, descriptors_to_add });
-//     }
-// }
 }
\ No newline at end of file
@@ -8,6 +8,9 @@
 #include "Texture.h"
 #include "freetype.h"
 #include "Buffer.h"
+#include "BindCache.h"
+#include "RingBuffer.h"
+#include "SpriteBatch.h"
 #include "Constants.h"
 #include "DescriptorPool.h"
 #include "Context.h"
@@ -17,7 +20,6 @@ class FreeType;
 class Device;
 class CommandPool;
 class GraphicsPipeline;
-class CommandBuffer;
 class DescriptorSetLayout;
 class Sampler;
 
@@ -32,60 +34,56 @@ public:
         const CommandPool& pool, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
         VkSampleCountFlagBits samples);
 
-    void RenderTextRel(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-        const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms, uint32_t current_frame, std::string_view text,
+    // Lay out every glyph quad of text, append them to geometry and draw them with one draw call. The quads are drawn with the shared
+    // quad index buffer of quads.
+    void RenderTextRel(BindCache& binds, RingBuffer& geometry, const SpriteBatch& quads, const GraphicsPipeline& pipeline, uint32_t current_frame,
+        std::string_view text,
         Color color, float font_size, float x, float y, VkExtent2D swapchain_extent, HorizontalAlignment halign, VerticalAlignment valign,
         float row_width = std::numeric_limits<float>::max());
 
-    void RenderTextAbs(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-        const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms, uint32_t current_frame, std::string_view text,
+    void RenderTextAbs(BindCache& binds, RingBuffer& geometry, const SpriteBatch& quads, const GraphicsPipeline& pipeline, uint32_t current_frame,
+        std::string_view text,
         Color color, float font_size, float x, float y, HorizontalAlignment halign, VerticalAlignment valign,
         float row_width = std::numeric_limits<float>::max());
 
-    void ClearBuffers(uint32_t current_frame);
+    // Lay out every glyph quad of text like RenderTextRel, without drawing it. The vertices are valid until the next layout or render.
+    const std::vector<float>& LayoutTextRel(std::string_view text, float font_size, float x, float y, VkExtent2D swapchain_extent,
+        HorizontalAlignment halign, VerticalAlignment valign, float row_width = std::numeric_limits<float>::max());
+
+    // Draw quad_count glyph quads laid out by LayoutTextRel, which start at offset in buffer, with one draw call
+    void DrawText(BindCache& binds, const SpriteBatch& quads, const GraphicsPipeline& pipeline, uint32_t current_frame, VkBuffer buffer,
+        VkDeviceSize offset, uint32_t quad_count, Color color) const;
+
+    // The number of glyph quads in count floats of laid out vertices
+    static constexpr uint32_t GetQuadCount(size_t count) noexcept { return static_cast<uint32_t>(count / (4 * FLOATS_PER_VERTEX)); }
 
 private:
+    static constexpr uint32_t MIN_ATLAS_SIZE = 256;  // The atlas starts at this size and doubles until every glyph fits
+    static constexpr uint32_t MAX_ATLAS_SIZE = 4096;
+    static constexpr size_t FLOATS_PER_VERTEX = 4; // Position (x, y), texture coordinates (u, v)
+
     // Information about a glyph
     struct Glyph {
         glm::vec<2, unsigned> size;
         glm::vec<2, int> bearing;
         FT_Pos advance;
+        Rect uv; // The glyph's part of the atlas, in texture coordinates. Empty for glyphs without a bitmap.
     };
 
-    VkDevice device;
-    std::unordered_map<FT_ULong, Texture> bitmaps;
+    Texture atlas; // The bitmaps of every glyph, packed into one R8 texture
     DescriptorPool descriptor_pool;
-    std::array<std::vector<VkDescriptorSet>, MAX_FRAMES_IN_FLIGHT> bitmap_descriptors;
+    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptors; // The atlas and the projection of each frame in flight
     
     std::unordered_map<FT_ULong, Glyph> glyphs;
-    std::array<std::vector<Buffer>, MAX_FRAMES_IN_FLIGHT> vertex_buffers, index_buffers;
-    std::array<std::vector<Buffer>, MAX_FRAMES_IN_FLIGHT> vertex_staging_buffers, index_staging_buffers;
-    std::array<size_t, MAX_FRAMES_IN_FLIGHT> current_buffer_positions;
-    std::array<std::vector<Buffer>, MAX_FRAMES_IN_FLIGHT> color_uniforms;
-    std::array<std::vector<void*>, MAX_FRAMES_IN_FLIGHT> color_uniforms_mapped;
-
-    // Text rendering
-
-    size_t RenderTextRow(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-        const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-        uint32_t current_frame, std::string_view row, float font_size, float x, float y, float row_width);
-
-    void RenderWord(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-        const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-        uint32_t current_frame, std::string_view word, float font_size, float x, float y);
-
-    std::pair<float, float> RenderWordMultiline(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool,
-        const CommandBuffer& command_buffer, const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler,
-        std::span<const Buffer> projection_uniforms, uint32_t current_frame, std::string_view word, float font_size, float x, float y,
-        float row_width, HorizontalAlignment halign, VerticalAlignment valign);
+    std::vector<float> vertices; // The glyph quads of the string being laid out, 4 vertices each
 
-    void RenderChar(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-        const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-        uint32_t current_frame, FT_ULong ch, float font_size, float x, float y);
+    // Text layout. These append the quads of the glyphs to vertices.
 
-    void RenderCharOpt(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, const CommandBuffer& command_buffer,
-        const GraphicsPipeline& pipeline, const DescriptorSetLayout& layout, const Sampler& sampler, std::span<const Buffer> projection_uniforms,
-        uint32_t current_frame, FT_ULong ch, float font_size, float x, float y);
+    size_t RenderTextRow(std::string_view row, float font_size, float x, float y, float row_width);
+    void RenderWord(std::string_view word, float font_size, float x, float y);
+    std::pair<float, float> RenderWordMultiline(std::string_view word, float font_size, float x, float y, float row_width,
+        HorizontalAlignment halign, VerticalAlignment valign);
+    void RenderChar(FT_ULong ch, float font_size, float x, float y);
 
     // Text manipulation
     
@@ -97,7 +95,7 @@ private:
 
     // Construction helper functions
 
-    void CreateDescriptorPool(const Device& device, const DescriptorSetLayout& layout, size_t total_glyphs);
+    void CreateDescriptorPool(const Device& device);
 };
 }
 
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cstring>
+#include "BindCache.h"
+
+namespace VKKit {
+BindCache::BindCache() noexcept :
+    command_buffer{ nullptr }, stats{}
+{
+    Invalidate();
+}
+
+void BindCache::Begin(VkCommandBuffer command_buffer) noexcept
+{
+    this->command_buffer = command_buffer;
+    Invalidate();
+}
+
+void BindCache::Invalidate() noexcept
+{
+    pipeline = nullptr;
+    sets = {};
+    vertex_buffers = {};
+    index_buffer = {};
+    index_type = VK_INDEX_TYPE_MAX_ENUM;
+    viewport_set = false;
+    scissor_set = false;
+}
+
+bool BindCache::Record(bool needed) noexcept
+{
+    if (needed) ++stats.binds;
+    else ++stats.elided_binds;
+    return needed;
+}
+
+void BindCache::BindPipeline(VkPipeline pipeline) noexcept
+{
+    if (!Record(this->pipeline != pipeline)) return;
+
+    this->pipeline = pipeline;
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+}
+
+void BindCache::BindDescriptorSet(VkPipelineLayout layout, uint32_t slot, VkDescriptorSet set, std::span<const uint32_t> dynamic_offsets) noexcept
+{
+    const auto record = [&] {
+        vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, layout, slot, 1, &set, static_cast<uint32_t>(dynamic_offsets.size()),
+            dynamic_offsets.data());
+    };
+
+    if (slot >= MAX_SETS || dynamic_offsets.size() > MAX_DYNAMIC_OFFSETS) {
+        Record(true);
+        record();
+        if (slot < MAX_SETS) std::fill(sets.begin() + slot, sets.end(), BoundSet{});
+        return;
+    }
+
+    BoundSet& bound = sets[slot];
+    const bool same = bound.layout == layout && bound.set == set && bound.dynamic_offset_count == dynamic_offsets.size() &&
+        std::equal(dynamic_offsets.begin(), dynamic_offsets.end(), bound.dynamic_offsets.begin());
+    if (!Record(!same)) return;
+
+    record();
+
+    // A set bound with another layout may disturb the sets bound with the previous one, below it as well as above it
+    if (bound.layout != layout) std::fill(sets.begin() + slot + 1, sets.end(), BoundSet{});
+    for (uint32_t i = 0; i < slot; ++i)
+        if (sets[i].layout != layout) sets[i] = BoundSet{};
+
+    bound.layout = layout;
+    bound.set = set;
+    bound.dynamic_offset_count = static_cast<uint32_t>(dynamic_offsets.size());
+    std::copy(dynamic_offsets.begin(), dynamic_offsets.end(), bound.dynamic_offsets.begin());
+}
+
+void BindCache::BindVertexBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset) noexcept
+{
+    if (binding < MAX_VERTEX_BUFFERS) {
+        BoundBuffer& bound = vertex_buffers[binding];
+        if (!Record(bound.buffer != buffer || bound.offset != offset)) return;
+        bound = BoundBuffer{ buffer, offset };
+    }
+    else Record(true);
+
+    vkCmdBindVertexBuffers(command_buffer, binding, 1, &buffer, &offset);
+}
+
+void BindCache::BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type) noexcept
+{
+    if (!Record(index_buffer.buffer != buffer || index_buffer.offset != offset || index_type != type)) return;
+
+    index_buffer = BoundBuffer{ buffer, offset };
+    index_type = type;
+    vkCmdBindIndexBuffer(command_buffer, buffer, offset, type);
+}
+
+void BindCache::SetViewport(const VkViewport& viewport) noexcept
+{
+    if (!Record(!viewport_set || memcmp(&this->viewport, &viewport, sizeof(VkViewport)) != 0)) return;
+
+    this->viewport = viewport;
+    viewport_set = true;
+    vkCmdSetViewport(command_buffer, 0, 1, &viewport);
+}
+
+void BindCache::SetScissor(const VkRect2D& scissor) noexcept
+{
+    if (!Record(!scissor_set || memcmp(&this->scissor, &scissor, sizeof(VkRect2D)) != 0)) return;
+
+    this->scissor = scissor;
+    scissor_set = true;
+    vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+}
+}
\ No newline at end of file
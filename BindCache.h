@@ -0,0 +1,76 @@
+#ifndef BINDCACHE_H
+#define BINDCACHE_H
+
+#include <array>
+#include <span>
+#include <cstdint>
+#include "vulkan/vulkan.h"
+#include "RecordingStats.h"
+
+namespace VKKit {
+// Records binds into a command buffer, skipping the ones that would bind what the command buffer already has bound. Every bind made
+// through the cache is tracked, so anything bound into the command buffer without it must be followed by Invalidate(). Only graphics
+// binds are tracked.
+class BindCache {
+public:
+    static constexpr uint32_t MAX_SETS = 4;            // Descriptor set slots tracked, binds to higher slots are always recorded
+    static constexpr uint32_t MAX_VERTEX_BUFFERS = 2;  // Vertex buffer bindings tracked, binds to higher bindings are always recorded
+    static constexpr uint32_t MAX_DYNAMIC_OFFSETS = 2; // Sets bound with more dynamic offsets are always rebound
+
+    BindCache() noexcept;
+
+    // Start binding into command_buffer, which has nothing bound yet. The statistics are kept.
+    void Begin(VkCommandBuffer command_buffer) noexcept;
+
+    // Forget what is bound, so the next bind of everything is recorded
+    void Invalidate() noexcept;
+
+    VkCommandBuffer Get() const noexcept { return command_buffer; }
+
+    void BindPipeline(VkPipeline pipeline) noexcept;
+
+    /**
+     * @brief Bind a descriptor set. Binding a set with a different layout than the set bound before it in its slot may disturb the
+     *        higher slots, and the lower slots bound with other layouts, so they are forgotten.
+     */
+    void BindDescriptorSet(VkPipelineLayout layout, uint32_t slot, VkDescriptorSet set, std::span<const uint32_t> dynamic_offsets = {}) noexcept;
+
+    void BindVertexBuffer(uint32_t binding, VkBuffer buffer, VkDeviceSize offset) noexcept;
+    void BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType type) noexcept;
+    void SetViewport(const VkViewport& viewport) noexcept;
+    void SetScissor(const VkRect2D& scissor) noexcept;
+
+    // The binds recorded and skipped since the last ResetStats
+    const RecordingStats& GetStats() const noexcept { return stats; }
+    void ResetStats() noexcept { stats = {}; }
+
+private:
+    struct BoundSet {
+        VkPipelineLayout layout;
+        VkDescriptorSet set;
+        uint32_t dynamic_offset_count;
+        std::array<uint32_t, MAX_DYNAMIC_OFFSETS> dynamic_offsets;
+    };
+
+    struct BoundBuffer {
+        VkBuffer buffer;
+        VkDeviceSize offset;
+    };
+
+    VkCommandBuffer command_buffer;
+    VkPipeline pipeline;
+    std::array<BoundSet, MAX_SETS> sets;
+    std::array<BoundBuffer, MAX_VERTEX_BUFFERS> vertex_buffers;
+    BoundBuffer index_buffer;
+    VkIndexType index_type;
+    VkViewport viewport;
+    VkRect2D scissor;
+    bool viewport_set, scissor_set;
+    RecordingStats stats;
+
+    // Count a bind, returning whether it has to be recorded
+    bool Record(bool needed) noexcept;
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include "BindlessTextures.h"
+#include "VkResultString.h"
+#include "Device.h"
+
+namespace VKKit {
+// The number of textures the device can hold in one update after bind set, up to MAX_TEXTURES
+static uint32_t GetMaxTextures(VkPhysicalDevice physical_device)
+{
+    VkPhysicalDeviceDescriptorIndexingProperties indexing = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES };
+    VkPhysicalDeviceProperties2 properties = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &indexing };
+    vkGetPhysicalDeviceProperties2(physical_device, &properties);
+
+    return std::min({ BindlessTextures::MAX_TEXTURES, indexing.maxDescriptorSetUpdateAfterBindSamplers,
+        indexing.maxDescriptorSetUpdateAfterBindSampledImages, indexing.maxPerStageDescriptorUpdateAfterBindSamplers,
+        indexing.maxPerStageDescriptorUpdateAfterBindSampledImages });
+}
+
+BindlessTextures::BindlessTextures() noexcept :
+    device{ nullptr }, capacity{ 0 }, set{ nullptr }
+{}
+
+BindlessTextures::BindlessTextures(VkPhysicalDevice physical_device, const Device& device) :
+    device{ device.Get() }, capacity{ GetMaxTextures(physical_device) }
+{
+    const std::array<VkDescriptorSetLayoutBinding, 1> bindings = {
+        VkDescriptorSetLayoutBinding {
+            .binding = 0,
+            .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = capacity,
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .pImmutableSamplers = nullptr
+        }
+    };
+
+    // Slots are written while frames that use other slots are in flight, and slots that were never written are never read
+    static constexpr std::array<VkDescriptorBindingFlags, 1> binding_flags = {
+        VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+    };
+
+    layout = DescriptorSetLayout(device, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, bindings, binding_flags);
+
+    const std::array<VkDescriptorPoolSize, 1> pool_sizes = {
+        VkDescriptorPoolSize {
+            .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+            .descriptorCount = capacity
+        }
+    };
+
+    pool = DescriptorPool(device, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT, pool_sizes, 1);
+
+    const VkDescriptorSetLayout set_layout = layout.Get();
+    const VkDescriptorSetAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = pool.Get(),
+        .descriptorSetCount = 1,
+        .pSetLayouts = &set_layout
+    };
+
+    const auto result = vkAllocateDescriptorSets(this->device, &alloc_info, &set);
+    if (result != VK_SUCCESS) ThrowError("Failed to create bindless texture descriptor set.", result);
+}
+
+void BindlessTextures::Set(uint32_t index, VkImageView view, VkSampler sampler)
+{
+    if (index >= capacity) throw std::runtime_error("Too many textures. The bindless texture array is full.");
+
+    const VkDescriptorImageInfo image_info = { sampler, view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+
+    const VkWriteDescriptorSet write = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = set,
+        .dstBinding = 0,
+        .dstArrayElement = index,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
+        .pImageInfo = &image_info
+    };
+
+    vkUpdateDescriptorSets(device, 1, &write, 0, nullptr);
+}
+}
\ No newline at end of file
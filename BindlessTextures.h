@@ -0,0 +1,59 @@
+#ifndef BINDLESSTEXTURES_H
+#define BINDLESSTEXTURES_H
+
+#include <cstdint>
+#include "vulkan/vulkan.h"
+#include "DescriptorSetLayout.h"
+#include "DescriptorPool.h"
+
+namespace VKKit {
+class Device;
+
+// One descriptor set holding an array of every loaded texture, indexed by the shaders with the texture's index. The set is bound once
+// and shared by every frame, textures are written to it after it has been bound (slots that aren't written stay unbound), so draws with
+// different textures don't need a set bind between them. Needs the descriptor indexing features, see Device::SupportsBindless.
+class BindlessTextures {
+public:
+    static constexpr uint32_t MAX_TEXTURES = 16384; // Fewer if the device's update after bind limits are lower
+
+    BindlessTextures() noexcept;
+
+    /**
+     * @brief Create the texture array and its descriptor set
+     *
+     * @param physical_device The physical device used, whose limits cap the number of textures
+     * @param device The logical device used. It must support bindless textures.
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    BindlessTextures(VkPhysicalDevice physical_device, const Device& device);
+
+    BindlessTextures(const BindlessTextures&) = delete;
+    BindlessTextures& operator=(const BindlessTextures&) = delete;
+    BindlessTextures(BindlessTextures&&) noexcept = default;
+    BindlessTextures& operator=(BindlessTextures&&) noexcept = default;
+
+    /**
+     * @brief Write a texture to a slot of the array. The slot must not be used by a frame in flight.
+     * @param index The slot, which the shaders index the array with
+     * @param view The view of the texture, in shader read only layout
+     * @param sampler The sampler to read the texture with
+     *
+     * @throw std::runtime_error if index is past the capacity
+     */
+    void Set(uint32_t index, VkImageView view, VkSampler sampler);
+
+    const DescriptorSetLayout& GetLayout() const noexcept { return layout; }
+    VkDescriptorSet GetSet() const noexcept { return set; }
+    uint32_t GetCapacity() const noexcept { return capacity; }
+
+private:
+    VkDevice device;
+    uint32_t capacity;
+    DescriptorSetLayout layout;
+    DescriptorPool pool;
+    VkDescriptorSet set;
+};
+}
+
+#endif
\ No newline at end of file
@@ -1,15 +1,25 @@
 #include "Buffer.h"
 #include "VkResultString.h"
 #include "rspan.h"
-#include "CommandBuffer.h"
 #include "Device.h"
+#include "UploadQueue.h"
 
 namespace VKKit {
-Buffer::Buffer() : device{ nullptr}, buffer{ nullptr }, memory{ nullptr }
+// Buffers are accounted for by what they are bound as. A buffer that is only ever copied from is a staging buffer.
+static MemoryCategory CategorizeBuffer(VkBufferUsageFlags usage) noexcept
+{
+    if (usage & (VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT)) return MemoryCategory::GEOMETRY;
+    if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) return MemoryCategory::UNIFORM;
+    if (usage == VK_BUFFER_USAGE_TRANSFER_SRC_BIT) return MemoryCategory::STAGING;
+    return MemoryCategory::OTHER;
+}
+
+Buffer::Buffer() : device{ nullptr}, buffer{ nullptr }, size{ 0 }, allocator{ nullptr }, allocation{}, graphics_owned{ false }
 {}
 
 Buffer::Buffer(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage,
-    VkMemoryPropertyFlags properties, VkSharingMode sharing_mode) : device{ device }
+    VkMemoryPropertyFlags properties, VkSharingMode sharing_mode) : device{ device }, size{ size }, allocator{ nullptr }, allocation{},
+    graphics_owned{ false }
 {
     const VkBufferCreateInfo buffer_info = {
         .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
@@ -30,110 +40,193 @@ Buffer::Buffer(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize s
         .memoryTypeIndex = FindMemoryType(physical_device, mem_requirements.memoryTypeBits, properties)
     };
 
-    const auto alloc_result = vkAllocateMemory(device, &alloc_info, nullptr, &memory);
+    allocation.size = mem_requirements.size;
+    allocation.memory_type = alloc_info.memoryTypeIndex;
+    allocation.block = MemoryAllocator::DEDICATED_BLOCK;
+
+    const auto alloc_result = vkAllocateMemory(device, &alloc_info, nullptr, &allocation.memory);
     if (alloc_result != VK_SUCCESS) {
         vkDestroyBuffer(device, buffer, nullptr);
         ThrowError("Failed to allocate buffer memory.", alloc_result);
     }
 
-    const auto bind_result = vkBindBufferMemory(device, buffer, memory, 0);
+    const auto bind_result = vkBindBufferMemory(device, buffer, allocation.memory, 0);
     if (bind_result != VK_SUCCESS) {
-        vkFreeMemory(device, memory, nullptr);
+        vkFreeMemory(device, allocation.memory, nullptr);
         vkDestroyBuffer(device, buffer, nullptr);
         ThrowError("Failed to bind memory.", bind_result);
     }
+
+    if (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        const auto map_result = vkMapMemory(device, allocation.memory, 0, VK_WHOLE_SIZE, 0, &allocation.mapped);
+        if (map_result != VK_SUCCESS) {
+            vkFreeMemory(device, allocation.memory, nullptr);
+            vkDestroyBuffer(device, buffer, nullptr);
+            ThrowError("Failed to map buffer memory.", map_result);
+        }
+    }
 }
 
 Buffer::Buffer(VkPhysicalDevice physical_device, const Device& device, VkDeviceSize size, VkBufferUsageFlags usage,
     VkMemoryPropertyFlags properties, VkSharingMode sharing_mode) :
-    Buffer(physical_device, device.Get(), size, usage, properties, sharing_mode)
+    Buffer(device.Get(), device.GetAllocator(), size, usage, properties, sharing_mode)
 {}
 
-Buffer Buffer::CreateVertexBuffer(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, ut::rspan<const float> vertices,
-    VkSharingMode sharing_mode)
+Buffer::Buffer(VkDevice device, MemoryAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+    VkSharingMode sharing_mode) :
+    device{ device }, size{ size }, allocator{ &allocator }, allocation{}, graphics_owned{ false }
 {
-    const VkDeviceSize size = vertices.size_bytes();
+    const auto mem_requirements = CreateBuffer(size, usage, sharing_mode);
 
-    const Buffer staging(physical_device, device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sharing_mode);
+    try {
+        allocation = allocator.Allocate(mem_requirements, properties, CategorizeBuffer(usage));
+    }
+    catch (...) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        throw;
+    }
 
-    void* data;
-    vkMapMemory(device.Get(), staging.GetMemory(), 0, size, 0, &data);
-    memcpy(data, vertices.data(), size);
-    vkUnmapMemory(device.Get(), staging.GetMemory());
+    BindMemory();
+}
 
-    Buffer vertex(physical_device, device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sharing_mode);
+Buffer::Buffer(const Device& device, VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memory_usage, VkSharingMode sharing_mode) :
+    Buffer(device.Get(), device.GetAllocator(), size, usage, memory_usage, sharing_mode)
+{}
 
-    CopyBuffer(device, pool, vertex, staging, size);
+Buffer::Buffer(VkDevice device, MemoryAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memory_usage,
+    VkSharingMode sharing_mode) :
+    device{ device }, size{ size }, allocator{ &allocator }, allocation{}, graphics_owned{ false }
+{
+    const auto mem_requirements = CreateBuffer(size, usage, sharing_mode);
 
-    return vertex;
+    try {
+        allocation = allocator.Allocate(mem_requirements, memory_usage, CategorizeBuffer(usage));
+    }
+    catch (...) {
+        vkDestroyBuffer(device, buffer, nullptr);
+        throw;
+    }
+
+    BindMemory();
 }
 
-Buffer Buffer::CreateIndexBuffer(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, ut::rspan<const uint32_t> indices,
+Buffer Buffer::CreateVertexBuffer(VkPhysicalDevice physical_device, const Device& device, ut::rspan<const float> vertices,
     VkSharingMode sharing_mode)
 {
-    const VkDeviceSize size = indices.size_bytes();
+    const VkDeviceSize size = vertices.size_bytes();
+
+    Buffer vertex(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, MemoryUsage::STATIC, sharing_mode);
 
-    const Buffer staging(physical_device, device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, sharing_mode);
+    if (vertex.GetMapped()) memcpy(vertex.GetMapped(), vertices.data(), size);
+    else device.GetUploadQueue().Upload(vertex, vertices.data(), size);
+
+    return vertex;
+}
 
-    void* data;
-    vkMapMemory(device.Get(), staging.GetMemory(), 0, size, 0, &data);
-    memcpy(data, indices.data(), size);
-    vkUnmapMemory(device.Get(), staging.GetMemory());
+Buffer Buffer::CreateIndexBuffer(VkPhysicalDevice physical_device, const Device& device, ut::rspan<const uint32_t> indices,
+    VkSharingMode sharing_mode)
+{
+    const VkDeviceSize size = indices.size_bytes();
 
-    Buffer index(physical_device, device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, sharing_mode);
+    Buffer index(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT, MemoryUsage::STATIC, sharing_mode);
 
-    CopyBuffer(device, pool, index, staging, size);
+    if (index.GetMapped()) memcpy(index.GetMapped(), indices.data(), size);
+    else device.GetUploadQueue().Upload(index, indices.data(), size);
 
     return index;
 }
 
 Buffer::~Buffer()
 {
-    if (device) {
-        vkFreeMemory(device, memory, nullptr);
-        vkDestroyBuffer(device, buffer, nullptr);
-    }
+    Destroy();
 }
 
 Buffer::Buffer(Buffer&& b) noexcept :
-    device{ b.device }, buffer{ b.buffer }, memory{ b.memory }
+    device{ b.device }, buffer{ b.buffer }, size{ b.size }, allocator{ b.allocator }, allocation{ b.allocation },
+    graphics_owned{ b.graphics_owned }
 {
     b.device = nullptr;
     b.buffer = nullptr;
-    b.memory = nullptr;
+    b.size = 0;
+    b.allocator = nullptr;
+    b.allocation = {};
+    b.graphics_owned = false;
 }
 
 Buffer& Buffer::operator=(Buffer&& b) noexcept
 {
-    if (device) {
-        vkFreeMemory(device, memory, nullptr);
-        vkDestroyBuffer(device, buffer, nullptr);
-    }
+    Destroy();
 
     device = b.device;
     buffer = b.buffer;
-    memory = b.memory;
+    size = b.size;
+    allocator = b.allocator;
+    allocation = b.allocation;
+    graphics_owned = b.graphics_owned;
 
     b.device = nullptr;
     b.buffer = nullptr;
-    b.memory = nullptr;
+    b.size = 0;
+    b.allocator = nullptr;
+    b.allocation = {};
+    b.graphics_owned = false;
 
     return *this;
 }
 
-void Buffer::WriteData(const Device& device, const CommandPool& command_pool, const Buffer& staging, const void* input,
-    VkDeviceSize size) const
+uint64_t Buffer::WriteData(const Device& device, const Buffer& staging, const void* input, VkDeviceSize size) const
 {
-    void* data;
-    vkMapMemory(device.Get(), staging.GetMemory(), 0, size, 0, &data);
-    memcpy(data, input, size); // TO DO: Fix this, causes access violation
-    vkUnmapMemory(device.Get(), staging.GetMemory());
+    // Frames in flight may still be reading the buffer, so even host visible memory isn't written directly. The copy is recorded on the
+    // graphics side, after them.
+    memcpy(staging.GetMapped(), input, size);
+
+    const VkBuffer src = staging.GetBuffer(), dst = buffer;
+    return device.GetUploadQueue().RecordGraphics([&](VkCommandBuffer command_buffer) {
+        const VkBufferCopy region = {
+            .srcOffset = 0,
+            .dstOffset = 0,
+            .size = size
+        };
+
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+        vkCmdCopyBuffer(command_buffer, src, dst, 1, &region);
+    });
+}
+
+VkMemoryRequirements Buffer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkSharingMode sharing_mode)
+{
+    const VkBufferCreateInfo buffer_info = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+        .size = size,
+        .usage = usage,
+        .sharingMode = sharing_mode
+    };
+
+    const auto buf_result = vkCreateBuffer(device, &buffer_info, nullptr, &buffer);
+    if (buf_result != VK_SUCCESS) ThrowError("Failed to create buffer.", buf_result);
 
-    CopyBuffer(device, command_pool, *this, staging, size);
+    VkMemoryRequirements mem_requirements;
+    vkGetBufferMemoryRequirements(device, buffer, &mem_requirements);
+    return mem_requirements;
+}
+
+void Buffer::BindMemory()
+{
+    const auto bind_result = vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+    if (bind_result != VK_SUCCESS) {
+        allocator->Free(allocation);
+        vkDestroyBuffer(device, buffer, nullptr);
+        ThrowError("Failed to bind memory.", bind_result);
+    }
+}
+
+void Buffer::Destroy() noexcept
+{
+    if (!device) return;
+
+    vkDestroyBuffer(device, buffer, nullptr);
+    if (allocator) allocator->Free(allocation);
+    else vkFreeMemory(device, allocation.memory, nullptr);
 }
 
 uint32_t FindMemoryType(VkPhysicalDevice physical_device, uint32_t type_filter, VkMemoryPropertyFlags properties)
@@ -149,23 +242,8 @@ uint32_t FindMemoryType(VkPhysicalDevice physical_device, uint32_t type_filter,
     throw std::runtime_error("Failed to find suitable memory type");
 }
 
-Buffer CreateStagingBuffer(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize size)
-{
-    return Buffer(physical_device, device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
-        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
-}
-
-void CopyBuffer(const Device& device, const CommandPool& command_pool, const Buffer& dst, const Buffer& src, VkDeviceSize size)
+Buffer CreateStagingBuffer(VkPhysicalDevice physical_device, const Device& device, VkDeviceSize size)
 {
-    const CommandBuffer command_buffer(device, command_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-    command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
-    const VkBufferCopy copy_region = {
-        .size = size
-    };
-    vkCmdCopyBuffer(command_buffer.GetBuffer(), src.GetBuffer(), dst.GetBuffer(), 1, &copy_region);
-
-    command_buffer.End();
-    command_buffer.Submit(device.GetGraphicsQueue(), true);
+    return Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::UPLOAD);
 }
 }
\ No newline at end of file
@@ -4,24 +4,42 @@
 #include "vulkan/vulkan.h"
 #include "rspan.h"
 #include "RenderData.h"
+#include "MemoryAllocator.h"
 
 namespace VKKit {
 class Device;
-class CommandPool;
+class UploadQueue;
 
+// A Vulkan buffer together with the device memory backing it. Buffers created from a Device are sub-allocated from the device's
+// MemoryAllocator, and host visible buffers stay mapped for their whole lifetime.
 class Buffer {
 public:
     Buffer();
+
+    // Create a buffer with its own VkDeviceMemory. Prefer the Device overload, which sub-allocates from the device's MemoryAllocator.
     Buffer(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize size, VkBufferUsageFlags usage,
         VkMemoryPropertyFlags properties, VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE);
     Buffer(VkPhysicalDevice physical_device, const Device& device, VkDeviceSize size, VkBufferUsageFlags usage,
         VkMemoryPropertyFlags properties, VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE);
+    Buffer(VkDevice device, MemoryAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+        VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE);
+
+    // Create a buffer whose memory type is picked by the allocator's MemoryPolicy. Check GetMapped() to find out whether it can be
+    // written to directly.
+    Buffer(const Device& device, VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memory_usage,
+        VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE);
+    Buffer(VkDevice device, MemoryAllocator& allocator, VkDeviceSize size, VkBufferUsageFlags usage, MemoryUsage memory_usage,
+        VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE);
     ~Buffer();
 
-    static Buffer CreateVertexBuffer(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, ut::rspan<const float> vertices,
+    // Create a static vertex buffer. If its memory is host visible the data is written directly, otherwise it is uploaded through the
+    // device's UploadQueue, which is flushed by the Context before the next frame is submitted.
+    static Buffer CreateVertexBuffer(VkPhysicalDevice physical_device, const Device& device, ut::rspan<const float> vertices,
         VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE);
 
-    static Buffer CreateIndexBuffer(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, ut::rspan<const uint32_t> indices,
+    // Create a static index buffer. If its memory is host visible the data is written directly, otherwise it is uploaded through the
+    // device's UploadQueue, which is flushed by the Context before the next frame is submitted.
+    static Buffer CreateIndexBuffer(VkPhysicalDevice physical_device, const Device& device, ut::rspan<const uint32_t> indices,
         VkSharingMode sharing_mode = VK_SHARING_MODE_EXCLUSIVE);
 
     Buffer(const Buffer& b) = delete;
@@ -31,29 +49,46 @@ public:
 
     /**
      * @brief Write data to this buffer. This function should only be used for device local buffers (not staging,
-     *        the ones used when drawing).
+     *        the ones used when drawing). The copy is recorded on the graphics side of the device's UploadQueue after a barrier, so frames
+     *        still in flight finish reading the old data first. That includes host visible buffers, which are not written directly.
      * @param device The logical device used
-     * @param command_pool The command pool used
-     * @param staging The staging buffer where the initial data will be written before being copied to this device local buffer
+     * @param staging The staging buffer where the initial data will be written before being copied to this device local buffer.
+     *        It must not be written to again until the returned ticket is complete.
      * @param input The data to copy
      * @param size The size of the data
+     * @return The upload queue ticket of the copy
      */
-    void WriteData(const Device& device, const CommandPool& command_pool, const Buffer& staging, const void* input,
-        VkDeviceSize size) const;
+    uint64_t WriteData(const Device& device, const Buffer& staging, const void* input, VkDeviceSize size) const;
 
     VkBuffer GetBuffer() const { return buffer; }
-    VkDeviceMemory GetMemory() const { return memory; }
+    VkDeviceSize GetSize() const { return size; }
+    VkDeviceMemory GetMemory() const { return allocation.memory; }
+
+    // The offset of the buffer inside GetMemory()
+    VkDeviceSize GetMemoryOffset() const { return allocation.offset; }
+
+    // A host pointer to the buffer's contents. Returns nullptr if the buffer's memory isn't host visible.
+    void* GetMapped() const { return allocation.mapped; }
 
 private:
     VkDevice device;
     VkBuffer buffer;
-    VkDeviceMemory memory;
+    VkDeviceSize size;
+    MemoryAllocator* allocator; // nullptr if the buffer owns its memory
+    Allocation allocation;
+
+    // Whether an UploadQueue has handed the buffer to the graphics queue, after which copies to it run on the graphics side. It belongs
+    // to the queue state of the buffer, not its contents, so it can change on a const Buffer.
+    mutable bool graphics_owned;
+    friend class UploadQueue;
+
+    VkMemoryRequirements CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkSharingMode sharing_mode);
+    void BindMemory();
+    void Destroy() noexcept;
 };
 
 uint32_t FindMemoryType(VkPhysicalDevice physical_device, uint32_t type_filter, VkMemoryPropertyFlags properties);
-Buffer CreateStagingBuffer(VkPhysicalDevice physical_device, VkDevice device, VkDeviceSize size);
-
-void CopyBuffer(const Device& device, const CommandPool& command_pool, const Buffer& dst, const Buffer& src, VkDeviceSize size);
+Buffer CreateStagingBuffer(VkPhysicalDevice physical_device, const Device& device, VkDeviceSize size);
 }
 
 #endif
\ No newline at end of file
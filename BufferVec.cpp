@@ -1,5 +1,34 @@
 #include "BufferVec.h"
 
 namespace VKKit {
+void DirtyRanges::Add(VkDeviceSize begin, VkDeviceSize end)
+{
+    if (begin >= end) return;
 
+    // Elements are usually changed in increasing order, so check the last range before searching
+    if (!ranges.empty() && begin >= ranges.back().begin) {
+        if (begin <= ranges.back().end + MERGE_DISTANCE) {
+            ranges.back().end = std::max(ranges.back().end, end);
+            return;
+        }
+
+        ranges.push_back(Range{ begin, end });
+        return;
+    }
+
+    // Find the first range which could merge with [begin, end), then swallow every range that overlaps it
+    auto first = std::lower_bound(ranges.begin(), ranges.end(), begin, [](const Range& r, VkDeviceSize b) { return r.end + MERGE_DISTANCE < b; });
+    auto last = first;
+    while (last != ranges.end() && last->begin <= end + MERGE_DISTANCE) {
+        begin = std::min(begin, last->begin);
+        end = std::max(end, last->end);
+        ++last;
+    }
+
+    if (first == last) ranges.insert(first, Range{ begin, end });
+    else {
+        *first = Range{ begin, end };
+        ranges.erase(first + 1, last);
+    }
+}
 }
\ No newline at end of file
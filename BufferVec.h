@@ -1,10 +1,238 @@
-//namespace VKKit {
-//template<typename T>
-//class BufferVec {
-//public:
-//    BufferVec();
+#ifndef BUFFERVEC_H
+#define BUFFERVEC_H
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include "vulkan/vulkan.h"
+#include "Buffer.h"
+#include "Device.h"
+#include "UploadQueue.h"
+#include "DeletionQueue.h"
+
+namespace VKKit {
+// A sorted list of non-overlapping byte ranges that have changed since the last upload. Ranges that touch, or are closer to each other
+// than MERGE_DISTANCE, are merged so that an upload doesn't end up with a copy region per element.
+class DirtyRanges {
+public:
+    static constexpr VkDeviceSize MERGE_DISTANCE = 256;
+
+    struct Range {
+        VkDeviceSize begin, end;
+    };
+
+    void Add(VkDeviceSize begin, VkDeviceSize end);
+    void Clear() noexcept { ranges.clear(); }
+
+    bool Empty() const noexcept { return ranges.empty(); }
+    const std::vector<Range>& Get() const noexcept { return ranges; }
+
+private:
+    std::vector<Range> ranges;
+};
+
+// A growable array of T kept both on the CPU and in a device buffer. Modifications are made to the CPU copy and are tracked, and Flush()
+// uploads only the changed ranges, in one batched copy. Call Flush() once per frame, before recording the draws that use the buffer.
 //
-//private:
-//    std::vector<T>
-//};
-//}
\ No newline at end of file
+// When the buffer's memory is host visible (unified memory, resizable BAR), Flush() writes the changed ranges through the mapping instead
+// of staging them. Frames in flight may be reading the buffer, so the changes go to a spare copy no frame reads anymore, which becomes
+// the buffer. A few spares are kept, each remembering the ranges it missed.
+template<typename T> requires std::is_trivially_copyable_v<T>
+class BufferVec {
+public:
+    BufferVec() noexcept : device{ nullptr }, usage{ 0 }, buffer_capacity{ 0 }, buffer_used{ false } {}
+
+    /**
+     * @brief Create an empty BufferVec
+     * @param device The logical device used
+     * @param usage What the device buffer will be used for (e.g. VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+     * @param capacity The number of elements to allocate space for up front
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    BufferVec(const Device& device, VkBufferUsageFlags usage, size_t capacity = 0) :
+        device{ &device }, usage{ usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT }, buffer_capacity{ 0 }, buffer_used{ false }
+    {
+        elements.reserve(capacity);
+        if (capacity != 0) Grow(capacity);
+    }
+
+    BufferVec(const BufferVec&) = delete;
+    BufferVec& operator=(const BufferVec&) = delete;
+    BufferVec(BufferVec&&) noexcept = default;
+    BufferVec& operator=(BufferVec&&) noexcept = default;
+
+    void push_back(const T& value)
+    {
+        elements.push_back(value);
+        MarkDirty(elements.size() - 1, elements.size());
+    }
+
+    void pop_back() { elements.pop_back(); }
+
+    void resize(size_t size, const T& value = T{})
+    {
+        const size_t old_size = elements.size();
+        elements.resize(size, value);
+        if (size > old_size) MarkDirty(old_size, size);
+    }
+
+    void reserve(size_t capacity) { elements.reserve(capacity); }
+    void clear() noexcept { elements.clear(); dirty.Clear(); }
+
+    // Non-const access marks the element as changed
+    T& operator[](size_t i)
+    {
+        MarkDirty(i, i + 1);
+        return elements[i];
+    }
+
+    const T& operator[](size_t i) const { return elements[i]; }
+
+    // Overwrite count elements starting at first, marking them as changed
+    void Write(size_t first, const T* values, size_t count)
+    {
+        std::copy(values, values + count, elements.begin() + first);
+        MarkDirty(first, first + count);
+    }
+
+    size_t size() const noexcept { return elements.size(); }
+    bool empty() const noexcept { return elements.empty(); }
+    const T* data() const noexcept { return elements.data(); }
+
+    // The device buffer. It changes when the BufferVec grows or writes a host visible spare, so get it again after every Flush().
+    VkBuffer GetBuffer() const noexcept { return buffer.GetBuffer(); }
+
+    /**
+     * @brief Upload the changed ranges to the device buffer, growing it geometrically if the elements no longer fit. Host visible
+     *        buffers are written directly. Otherwise the copy is recorded on the graphics side of the device's UploadQueue after a
+     *        barrier, so frames still in flight finish reading the old data before it is overwritten.
+     * @return The upload queue ticket of the copy, or 0 if nothing changed or the buffer was written directly
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    UploadQueue::Ticket Flush()
+    {
+        if (elements.size() > buffer_capacity) Grow(std::max(elements.size(), buffer_capacity * 2));
+
+        if (buffer.GetMapped()) {
+            FlushMapped();
+            return 0;
+        }
+
+        // Elements may have been removed after they were changed, those don't need uploading
+        const VkDeviceSize size_bytes = elements.size() * sizeof(T);
+        std::vector<VkBufferCopy> regions;
+        regions.reserve(dirty.Get().size());
+
+        VkDeviceSize staging_size = 0;
+        for (const auto& r : dirty.Get()) {
+            const VkDeviceSize end = std::min(r.end, size_bytes);
+            if (r.begin >= end) break;
+            regions.push_back(VkBufferCopy{ .srcOffset = staging_size, .dstOffset = r.begin, .size = end - r.begin });
+            staging_size += end - r.begin;
+        }
+        dirty.Clear();
+
+        if (regions.empty()) return 0;
+
+        Buffer staging = device->GetUploadQueue().AcquireStaging(staging_size);
+        for (const auto& r : regions)
+            memcpy(static_cast<char*>(staging.GetMapped()) + r.srcOffset, reinterpret_cast<const char*>(elements.data()) + r.dstOffset, r.size);
+
+        const VkBuffer src = staging.GetBuffer(), dst = buffer.GetBuffer();
+        return device->GetUploadQueue().RecordGraphics([&](VkCommandBuffer command_buffer) {
+            // Frames submitted earlier may still be reading the buffer
+            vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+            vkCmdCopyBuffer(command_buffer, src, dst, static_cast<uint32_t>(regions.size()), regions.data());
+        }, std::move(staging));
+    }
+
+private:
+    // A host visible copy of the buffer that was replaced by a newer one
+    struct Spare {
+        Buffer buffer;
+        DirtyRanges stale;             // The ranges changed since it was last written
+        DeletionQueue::Frame retired;  // Frames after this one don't read it
+    };
+
+    const Device* device;
+    VkBufferUsageFlags usage;
+    std::vector<T> elements;
+    Buffer buffer;
+    size_t buffer_capacity;
+    bool buffer_used; // Whether a frame may have read buffer since it was created
+    DirtyRanges dirty;
+    std::vector<Spare> spares;
+
+    void MarkDirty(size_t first, size_t last) { dirty.Add(first * sizeof(T), last * sizeof(T)); }
+
+    void FlushMapped()
+    {
+        if (dirty.Empty()) return;
+
+        // Nothing reads a new buffer yet, so it is written in place
+        if (!buffer_used) {
+            WriteMapped(buffer, dirty);
+            dirty.Clear();
+            buffer_used = true;
+            return;
+        }
+
+        DeletionQueue& deletion_queue = device->GetDeletionQueue();
+        const DeletionQueue::Frame completed = deletion_queue.GetCompletedFrame();
+
+        Spare next;
+        if (const auto it = std::ranges::find_if(spares, [&](const Spare& s) { return s.retired <= completed; }); it != spares.end()) {
+            next = std::move(*it);
+            spares.erase(it);
+        }
+        else {
+            // Dynamic memory is always host visible
+            next.buffer = Buffer(*device, buffer_capacity * sizeof(T), usage, MemoryUsage::DYNAMIC);
+            next.stale.Add(0, elements.size() * sizeof(T));
+        }
+
+        for (const auto& r : dirty.Get()) {
+            next.stale.Add(r.begin, r.end);
+            for (auto& s : spares) s.stale.Add(r.begin, r.end);
+        }
+
+        WriteMapped(next.buffer, next.stale);
+
+        // The replaced buffer misses this flush's changes, and the frame being recorded may still read it
+        spares.push_back(Spare{ std::move(buffer), std::move(dirty), deletion_queue.GetCurrentFrame() });
+        dirty.Clear();
+        buffer = std::move(next.buffer);
+    }
+
+    // Copy the ranges of the elements that still exist to the mapping of dst
+    void WriteMapped(const Buffer& dst, const DirtyRanges& ranges) const
+    {
+        const VkDeviceSize size_bytes = elements.size() * sizeof(T);
+        for (const auto& r : ranges.Get()) {
+            const VkDeviceSize end = std::min(r.end, size_bytes);
+            if (r.begin >= end) break;
+            memcpy(static_cast<char*>(dst.GetMapped()) + r.begin, reinterpret_cast<const char*>(elements.data()) + r.begin, end - r.begin);
+        }
+    }
+
+    void Grow(size_t capacity)
+    {
+        // Frames in flight may still be reading the old buffer and its spares
+        if (buffer.GetBuffer()) device->GetDeletionQueue().Defer(std::move(buffer));
+        for (auto& s : spares) device->GetDeletionQueue().Defer(std::move(s.buffer));
+        spares.clear();
+
+        buffer = Buffer(*device, capacity * sizeof(T), usage, MemoryUsage::STATIC);
+        buffer_capacity = capacity;
+        buffer_used = false;
+
+        // The new buffer starts out empty
+        MarkDirty(0, elements.size());
+    }
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "Filebuf.h"
+
+#include "VkResultString.h"
+#include "ComputePipeline.h"
+
+namespace VKKit {
+ComputePipeline::ComputePipeline() noexcept :
+    device{ nullptr }, layout{ nullptr }, pipeline{ nullptr }
+{}
+
+ComputePipeline::ComputePipeline(VkDevice device, std::string_view shader_file, const VkPipelineLayoutCreateInfo& pipeline_layout) :
+    device{ device }
+{
+    ut::Filebuf code(shader_file.data());
+
+    const VkShaderModuleCreateInfo module_info = {
+        .sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+        .codeSize = code.Size(),
+        .pCode = reinterpret_cast<const uint32_t*>(code.Get())
+    };
+
+    VkShaderModule shader;
+    const auto module_result = vkCreateShaderModule(device, &module_info, nullptr, &shader);
+    if (module_result != VK_SUCCESS) ThrowError("Failed to create shader module.", module_result);
+
+    const auto layout_result = vkCreatePipelineLayout(device, &pipeline_layout, nullptr, &layout);
+    if (layout_result != VK_SUCCESS) {
+        vkDestroyShaderModule(device, shader, nullptr);
+        ThrowError("Failed to create pipeline layout.", layout_result);
+    }
+
+    const VkComputePipelineCreateInfo pipeline_info = {
+        .sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+        .stage = {
+            .sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+            .stage = VK_SHADER_STAGE_COMPUTE_BIT,
+            .module = shader,
+            .pName = "main"
+        },
+        .layout = layout
+    };
+
+    // The module is only needed while the pipeline is created
+    const auto result_pipeline = vkCreateComputePipelines(device, nullptr, 1, &pipeline_info, nullptr, &pipeline);
+    vkDestroyShaderModule(device, shader, nullptr);
+
+    if (result_pipeline != VK_SUCCESS) {
+        vkDestroyPipelineLayout(device, layout, nullptr);
+        ThrowError("Failed to create compute pipeline.", result_pipeline);
+    }
+}
+
+ComputePipeline::~ComputePipeline()
+{
+    if (device) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    }
+}
+
+ComputePipeline::ComputePipeline(ComputePipeline&& cp) noexcept :
+    device{ cp.device }, layout{ cp.layout }, pipeline{ cp.pipeline }
+{
+    cp.device = nullptr;
+    cp.layout = nullptr;
+    cp.pipeline = nullptr;
+}
+
+ComputePipeline& ComputePipeline::operator=(ComputePipeline&& cp) noexcept
+{
+    if (device) {
+        vkDestroyPipeline(device, pipeline, nullptr);
+        vkDestroyPipelineLayout(device, layout, nullptr);
+    }
+
+    device = cp.device;
+    layout = cp.layout;
+    pipeline = cp.pipeline;
+    cp.device = nullptr;
+    cp.layout = nullptr;
+    cp.pipeline = nullptr;
+
+    return *this;
+}
+}
\ No newline at end of file
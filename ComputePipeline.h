@@ -0,0 +1,40 @@
+#ifndef COMPUTEPIPELINE_H
+#define COMPUTEPIPELINE_H
+
+#include <string_view>
+#include "vulkan/vulkan.hpp"
+
+namespace VKKit {
+// Compute pipeline, which runs one compute shader. Wrapper over VkPipelineLayout and VkPipeline.
+class ComputePipeline {
+public:
+    ComputePipeline() noexcept;
+
+    /**
+     * @brief Construct a compute pipeline
+     * 
+     * @param device The logical device which will use the pipeline.
+     * @param shader_file Path to the file with compute shader spv code.
+     * @param pipeline_layout What data bindings and push constants the pipeline will have.
+     * 
+     * @throw std::runtime_error with error information on failure
+     */
+    ComputePipeline(VkDevice device, std::string_view shader_file, const VkPipelineLayoutCreateInfo& pipeline_layout);
+    ~ComputePipeline();
+
+    ComputePipeline(const ComputePipeline& cp) = delete;
+    ComputePipeline& operator=(const ComputePipeline& cp) = delete;
+    ComputePipeline(ComputePipeline&& cp) noexcept;
+    ComputePipeline& operator=(ComputePipeline&& cp) noexcept;
+
+    VkPipelineLayout GetLayout() const noexcept { return layout; }
+    VkPipeline GetPipeline() const noexcept { return pipeline; }
+
+private:
+    VkDevice device;
+    VkPipelineLayout layout;
+    VkPipeline pipeline;
+};
+}
+
+#endif
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <optional>
 #include <chrono>
 #include <array>
+#include <mutex>
 
 #define GLM_FORCE_DEFAULT_ALIGNED_GENTYPES
 #define GLM_FORCE_RADIANS
@@ -31,6 +32,22 @@
 #include "Windowing.h"
 #include "Concurrency.h"
 #include "Buffer.h"
+#include "BindlessTextures.h"
+#include "RingBuffer.h"
+#include "MeshBuffer.h"
+#include "SpriteBatch.h"
+#include "RectBatch.h"
+#include "RetainedScene.h"
+#include "DrawList.h"
+#include "UniformRing.h"
+#include "TextureAtlas.h"
+#include "ParallelRecorder.h"
+#include "BindCache.h"
+#include "IndirectCuller.h"
+#include "Frustum.h"
+#include "UploadQueue.h"
+#include "DeletionQueue.h"
+#include "MemoryAllocator.h"
 #ifndef NDEBUG
 #include "Debugger.h"
 #endif
@@ -68,14 +85,21 @@ public:
     void Render3D(size_t texture, Cuboid area, const CameraView& camera);
     void Render3D(size_t texture, const Model& model, const CameraView& camera);
     void Color3D(Color color, Cuboid area, const CameraView& camera);
+    void Color3DInstanced(std::span<const Instance3D> instances, const CameraView& camera);
+    void Render3DInstanced(size_t texture, std::span<const Instance3D> instances, const CameraView& camera);
+    void Render3DInstanced(size_t texture, const Model& model, std::span<const Instance3D> instances, const CameraView& camera);
     void RenderTextRel(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width = std::numeric_limits<float>::max(),
         HorizontalAlignment halign = HorizontalAlignment::LEFT, VerticalAlignment valign = VerticalAlignment::TOP);
     void RenderTextAbs(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width = std::numeric_limits<float>::max(),
         HorizontalAlignment halign = HorizontalAlignment::LEFT, VerticalAlignment valign = VerticalAlignment::TOP);
 
+    RetainedScene& GetScene() noexcept { return scene; }
+    void RenderObjects(const CameraView& camera);
+
     // Load a texture from path and append to the array of textures
     void LoadTexture(std::string_view path);
     void LoadTextures(std::span<const std::string_view> paths);
+    std::vector<AtlasRegion> LoadAtlas(std::span<const std::string_view> paths, uint32_t page_size);
 
     void LoadAlphabet(std::string_view path);
     void LoadAlphabets(std::span<const std::string_view> paths);
@@ -83,8 +107,15 @@ public:
     const Window& GetWindow() const noexcept { return window; }
     VkExtent2D GetSwapchainExtent() const noexcept { return swapchain.GetExtent(); }
     Rect GetWindowRect() const noexcept;
+    MemoryReport GetMemoryReport() const { return device.GetAllocator().GetReport(); }
+    RecordingStats GetRecordingStats() const noexcept { return last_stats; }
+    bool UsesBindlessTextures() const noexcept { return bindless_textures.GetSet() != nullptr; }
 
     void SetFramebufferResized() noexcept { framebuffer_resized = true; }
+    void SetDeferredRendering(bool deferred) noexcept { deferred_rendering = deferred; }
+    void SetLayer(uint8_t layer) noexcept { current_layer = layer; }
+    void SetRecordingThreads(uint32_t count);
+    void SetGPUCulling(bool enabled);
 
     void SetParentWindow(void* native_handle);
 
@@ -102,7 +133,10 @@ private:
     Device device;
     RenderPass render_pass;
 
-    enum class GraphicsPipelines { COLOR2D, COLOR3D, TEXTURE2D, TEXTURE3D, TEXT, TOTAL_PIPELINES };
+    // The instanced pipelines use the descriptor set layouts of COLOR3D and TEXTURE3D, their own layouts stay empty. The bindless pipelines
+    // use the layouts of COLOR3D and of the texture array, and are only created when textures are bindless.
+    enum class GraphicsPipelines { COLOR2D, COLOR3D, TEXTURE2D, TEXTURE3D, TEXT, COLOR3D_INSTANCED, TEXTURE3D_INSTANCED, TEXTURE2D_BINDLESS,
+        TEXTURE3D_BINDLESS, TEXTURE3D_INSTANCED_BINDLESS, TOTAL_PIPELINES };
 
     std::array<DescriptorSetLayout, static_cast<size_t>(GraphicsPipelines::TOTAL_PIPELINES)> descriptor_set_layouts;
     Swapchain swapchain;
@@ -117,29 +151,138 @@ private:
     std::vector<VkDescriptorSet> texture_sets_2d;
     std::vector<VkDescriptorSet> texture_sets_3d;
 
+    // Every texture at its index, when the device supports bindless textures. The per texture sets above are then not created.
+    BindlessTextures bindless_textures;
+
     std::vector<Alphabet> alphabets;
 
-    std::array<std::vector<Buffer>, MAX_FRAMES_IN_FLIGHT> vertex_buffers;
-    std::array<std::vector<Buffer>, MAX_FRAMES_IN_FLIGHT> vertex_staging_buffers;
-    std::array<std::vector<Buffer>, MAX_FRAMES_IN_FLIGHT> index_buffers;
-    std::array<std::vector<Buffer>, MAX_FRAMES_IN_FLIGHT> index_staging_buffers;
-    std::array<size_t, MAX_FRAMES_IN_FLIGHT> current_buffer_positions;
+    // Vertices and indices of the immediate mode draws, rewritten every frame
+    std::array<RingBuffer, MAX_FRAMES_IN_FLIGHT> geometry_buffers;
+
+    // Static geometry shared by the cuboid draws
+    MeshBuffer cube_mesh;
+
+    // Render2D and Color2D calls of the current frame, drawn once something else is drawn or the frame ends. At most one of them holds
+    // anything at a time.
+    SpriteBatch sprite_batch;
+    RectBatch rect_batch;
+
+    // The retained objects, drawn by RenderObjects
+    RetainedScene scene;
 
     std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> color_sets;
 
     enum class TextureDescriptorSets { TEXTURE2D, TEXTURE3D, TOTAL };
     std::array<VkDescriptorSet, static_cast<size_t>(TextureDescriptorSets::TOTAL) * MAX_FRAMES_IN_FLIGHT> texture_sets;
 
-    enum class UniformBuffers { COLOR3D, TEXTURE3D, TEXT_PROJECTION, TOTAL };
+    enum class UniformBuffers { TEXT_PROJECTION, TOTAL };
     std::array<Buffer, static_cast<size_t>(UniformBuffers::TOTAL) * MAX_FRAMES_IN_FLIGHT> uniform_buffers;
     std::array<void*, static_cast<size_t>(UniformBuffers::TOTAL) * MAX_FRAMES_IN_FLIGHT> uniform_buffers_mapped;
+
+    // The view-projection matrices of the 3D draws, read at a dynamic offset by the Color3D and Texture3D sets of the frame
+    std::array<UniformRing, MAX_FRAMES_IN_FLIGHT> camera_uniforms;
     
     DescriptorPool descriptor_pool;
     Sampler sampler;
     
     std::vector<Model> models;
 
+    // A draw call queued while deferred rendering is on. Only the members its type uses are set.
+    struct DeferredDraw {
+        enum class Type : uint8_t { SPRITE, RECT, TEXTURED_CUBOID, TEXTURED_MODEL, COLORED_CUBOID, TEXT, INSTANCED };
+
+        Type type;
+        size_t texture; // The texture, or the font style of text
+        Color color;
+        Rect rect;
+        Rect src; // The part of the texture a sprite draws
+        Cuboid cuboid;
+        const Model* model;
+        uint32_t camera; // Index in deferred_cameras
+        uint32_t text;   // Index in deferred_texts
+
+        // Instanced draws: the pipeline, the instances (already written to the frame's geometry buffer) and the mesh (nullptr for the cube)
+        GraphicsPipelines pipeline;
+        RingBuffer::Range instances;
+        uint32_t instance_count;
+    };
+
+    struct DeferredText {
+        std::string text;
+        float x, y, size, row_width;
+        HorizontalAlignment halign;
+        VerticalAlignment valign;
+        bool absolute;
+    };
+
+    // A 3D draw with everything it binds resolved. Preparing a draw writes to the frame's buffers, so it happens on the calling thread,
+    // but recording a prepared draw only records commands and can happen on any thread.
+    struct Draw3D {
+        VkPipeline pipeline;
+        VkPipelineLayout layout;
+        VkDescriptorSet set;
+        uint32_t camera_offset; // The dynamic offset of the camera in the frame's camera uniforms
+        glm::mat4 model;
+
+        VkDescriptorSet texture_array; // Bound as set 1 by the bindless pipelines, nullptr otherwise
+        uint32_t texture_index;        // The texture in texture_array, pushed after the model matrix
+
+        const MeshBuffer* mesh;             // The shared mesh of the draw, or nullptr if it has its own vertices and indices
+        RingBuffer::Range vertices, indices; // The draw's own geometry in the frame's geometry buffer
+        uint32_t index_count;
+
+        RingBuffer::Range instances; // The per instance data of instanced draws
+        uint32_t instance_count;     // 0 if the draw isn't instanced
+
+        RingBuffer::Range indirect;       // The VkDrawIndexedIndirectCommand the draw reads its counts from, if buffer isn't nullptr
+        RingBuffer::Range indirect_count; // The number of draws of indirect (0 or 1) if buffer isn't nullptr, otherwise it is drawn once
+    };
+
+    // Record draw through binds, which skips the binds it shares with the draws recorded before it in the same command buffer
+    static void RecordDraw3D(BindCache& binds, const Draw3D& draw) noexcept;
+
+    bool deferred_rendering;
+    uint8_t current_layer;
+    uint32_t draw_sequence;  // The sequence number of the last queued draw, see DrawList
+    bool sequence_sortable;   // Whether the draws with draw_sequence may be sorted by state
+    DrawList draw_list;
+    std::vector<DeferredDraw> deferred_draws;
+    std::vector<CameraView> deferred_cameras; // Consecutive draws with the same camera share an entry
+    std::vector<DeferredText> deferred_texts;
+    std::vector<Draw3D> prepared_draws;
+
+    // The boxes of the queued cuboid and model draws, tested against their cameras' frustums before the draw list is sorted
+    BoxBatch deferred_boxes;
+    std::vector<uint32_t> deferred_boxed; // The draw of each box
+    std::vector<uint8_t> deferred_box_visible;
+    std::vector<uint8_t> deferred_visible; // Per queued draw
+
+    // The frustum of the camera immediate 3D draws were last culled with
+    std::optional<CameraView> frustum_camera;
+    Frustum frustum;
+
+    // Records long runs of deferred 3D draws on worker threads, when enabled with SetRecordingThreads. Every draw of the frame then goes
+    // to secondary command buffers, which the primary command buffer executes in the order they were recorded in.
+    std::unique_ptr<ParallelRecorder> recorder;
+    const CommandBuffer* recording; // The command buffer the calling thread records draws into
+    std::vector<VkCommandBuffer> secondaries;
+
+    // What recording has bound. The worker threads keep caches of their own and add their statistics to parallel_stats when they finish
+    // a slice.
+    BindCache binds;
+    std::mutex stats_mutex;
+    RecordingStats parallel_stats;
+    RecordingStats last_stats; // The statistics of the last frame that was ended
+
+    // Culls the retained 3D objects in a compute shader when enabled with SetGPUCulling. Dispatches can't be recorded inside the render
+    // pass, so they go to a command buffer of their own that is submitted ahead of the frame's.
+    IndirectCuller culler;
+    std::vector<CommandBuffer> cull_command_buffers;
+    bool gpu_culling;
+    bool culling_recorded; // Whether the current frame's cull command buffer has been begun
+
     uint32_t current_frame;
+    std::array<DeletionQueue::Frame, MAX_FRAMES_IN_FLIGHT> submitted_frames; // The deletion queue frame last submitted in each slot
     bool framebuffer_resized;
     std::chrono::high_resolution_clock::time_point time;
     uint32_t image_index;
@@ -152,6 +295,7 @@ private:
     void CreateTextureSampler();
     
     void CreateUniformBuffers();
+    void CreateGeometryBuffers();
     void CreateDescriptorPool();
     void CreateBuiltinDescriptorSets();
     void CreateCommandBuffers();
@@ -160,6 +304,69 @@ private:
     void RecreateSwapChain();
     void AddDescriptorSet2D(const Texture& texture);
     void AddDescriptorSet3D(const Texture& texture);
+    // Make the last texture in the array drawable, through the texture array or its own descriptor sets. An empty texture keeps its
+    // index without being drawable, so the index of a texture is its index in textures either way. Returns that index.
+    size_t RegisterTexture();
+
+    // Record into a new secondary command buffer of the calling thread. Only used while recording in parallel.
+    void BeginSecondary();
+    // End the secondary command buffer draws are recorded into and queue it for execution
+    void EndSecondary();
+    VkCommandBufferInheritanceInfo GetInheritanceInfo() noexcept;
+    // The current frame's cull command buffer, begun the first time it's needed in the frame
+    VkCommandBuffer BeginCulling();
+    void SetViewportAndScissor(BindCache& binds) const noexcept;
+
+    // Draw the sprites and rectangles queued by Render2D and Color2D. Every other draw calls this first, so the draws keep the order they
+    // were requested in.
+    void FlushBatches();
+    void FlushSprites();
+    void FlushRects();
+
+    // Record the draws
+    void RecordSprite(size_t texture, Rect src, Rect dst);
+    void RecordRect(Color color, Rect area);
+
+    // Resolve what a 3D draw binds. Its camera, and any geometry it doesn't share, are written to the frame's buffers.
+    Draw3D PrepareTexturedCuboid(size_t texture, Cuboid area, const CameraView& camera);
+    Draw3D PrepareTexturedModel(size_t texture, const Model& model, const CameraView& camera);
+    Draw3D PrepareColoredCuboid(Color color, Cuboid area, const CameraView& camera);
+    Draw3D PrepareInstanced(GraphicsPipelines pipeline, size_t texture, const MeshBuffer& mesh, RingBuffer::Range instances, uint32_t instance_count,
+        const CameraView& camera);
+    Draw3D PrepareDeferred(const DeferredDraw& draw);
+    Draw3D PrepareTransform(GraphicsPipelines pipeline, VkDescriptorSet set, const CameraView& camera, const glm::mat4& model);
+    // PrepareTransform for TEXTURE3D or TEXTURE3D_INSTANCED, switching to their bindless pipelines when textures are bindless
+    Draw3D PrepareTextured(GraphicsPipelines pipeline, size_t texture, const CameraView& camera, const glm::mat4& model);
+
+    // Record prepared 3D draws in order, on the worker threads when there are enough of them
+    void RecordDraws3D(std::span<const Draw3D> draws);
+
+    // Write instances to the current frame's geometry buffer and draw them immediately or queue them in the draw list
+    void DrawInstanced(GraphicsPipelines pipeline, size_t texture, const Model* model, std::span<const Instance3D> instances, const CameraView& camera);
+    void RecordTextRel(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
+        HorizontalAlignment halign, VerticalAlignment valign);
+    void RecordTextAbs(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
+        HorizontalAlignment halign, VerticalAlignment valign);
+
+    // Queue a draw in the draw list. depth is the distance of the draw from the camera (0 for 2D draws).
+    void Defer(const DeferredDraw& draw, GraphicsPipelines pipeline, float depth);
+
+    // Whether draw may be reordered with the draws around it. Only opaque, depth tested 3D draws can be, 2D draws and text blend over
+    // whatever is drawn before them.
+    static bool CanSortByState(const DeferredDraw& draw) noexcept;
+    uint32_t DeferCamera(const CameraView& camera);
+
+    // The frustum of camera, computed again only when the camera changes
+    const Frustum& GetFrustum(const CameraView& camera);
+
+    // Remove the queued cuboid and model draws that are outside their camera's frustum from the draw list
+    void CullDeferred();
+
+    // Sort the queued draws and record them
+    void ExecuteDrawList();
+
+    // The order of the pipelines among draws that are sorted by state
+    static constexpr uint32_t SortRank(GraphicsPipelines pipeline) noexcept;
 };
 
 Context::Impl::Impl(std::string_view window_title, int screenw, int screenh) :
@@ -180,10 +387,10 @@ Context::Impl::Impl(std::string_view window_title, int screenw, int screenh) :
     device{ Device(physical_device, VkPhysicalDeviceFeatures { .sampleRateShading = VK_TRUE, .samplerAnisotropy = VK_TRUE }, surface.Get(),
         DEVICE_EXTENSIONS) },
 #endif
-    current_frame{ 0 }, framebuffer_resized{ false },
+    deferred_rendering{ false }, current_layer{ 0 }, draw_sequence{ 0 }, sequence_sortable{ false }, recording{ nullptr }, parallel_stats{}, last_stats{}, gpu_culling{ false }, culling_recorded{ false },
+    current_frame{ 0 }, submitted_frames{}, framebuffer_resized{ false },
     time{ high_resolution_clock::now() },
-    image_index{ 0 },
-    current_buffer_positions{}
+    image_index{ 0 }
 {
     CreateRenderPass();
     CreateDescriptorLayout();
@@ -192,6 +399,7 @@ Context::Impl::Impl(std::string_view window_title, int screenw, int screenh) :
     CreateCommandPool();
     CreateTextureSampler();
     CreateUniformBuffers();
+    CreateGeometryBuffers();
     CreateDescriptorPool();
     CreateBuiltinDescriptorSets();
     CreateCommandBuffers();
@@ -216,10 +424,10 @@ Context::Impl::Impl(std::string_view window_title) :
     device{ Device(physical_device, VkPhysicalDeviceFeatures { .sampleRateShading = VK_TRUE, .samplerAnisotropy = VK_TRUE }, surface.Get(),
         DEVICE_EXTENSIONS) },
 #endif
-    current_frame{ 0 }, framebuffer_resized{ false },
+    deferred_rendering{ false }, current_layer{ 0 }, draw_sequence{ 0 }, sequence_sortable{ false }, recording{ nullptr }, parallel_stats{}, last_stats{}, gpu_culling{ false }, culling_recorded{ false },
+    current_frame{ 0 }, submitted_frames{}, framebuffer_resized{ false },
     time{ high_resolution_clock::now() },
-    image_index{ 0 },
-    current_buffer_positions{}
+    image_index{ 0 }
 {
     CreateRenderPass();
     CreateDescriptorLayout();
@@ -228,6 +436,7 @@ Context::Impl::Impl(std::string_view window_title) :
     CreateCommandPool();
     CreateTextureSampler();
     CreateUniformBuffers();
+    CreateGeometryBuffers();
     CreateDescriptorPool();
     CreateBuiltinDescriptorSets();
     CreateCommandBuffers();
@@ -252,10 +461,10 @@ Context::Impl::Impl(void* native_handle, bool drop) :
     device{ Device(physical_device, VkPhysicalDeviceFeatures { .sampleRateShading = VK_TRUE, .samplerAnisotropy = VK_TRUE }, surface.Get(),
         DEVICE_EXTENSIONS) },
 #endif
-    current_frame{ 0 }, framebuffer_resized{ false },
+    deferred_rendering{ false }, current_layer{ 0 }, draw_sequence{ 0 }, sequence_sortable{ false }, recording{ nullptr }, parallel_stats{}, last_stats{}, gpu_culling{ false }, culling_recorded{ false },
+    current_frame{ 0 }, submitted_frames{}, framebuffer_resized{ false },
     time{ high_resolution_clock::now() },
-    image_index{ 0 },
-    current_buffer_positions{}
+    image_index{ 0 }
 {
     CreateRenderPass();
     CreateDescriptorLayout();
@@ -264,6 +473,7 @@ Context::Impl::Impl(void* native_handle, bool drop) :
     CreateCommandPool();
     CreateTextureSampler();
     CreateUniformBuffers();
+    CreateGeometryBuffers();
     CreateDescriptorPool();
     CreateBuiltinDescriptorSets();
     CreateCommandBuffers();
@@ -273,6 +483,7 @@ Context::Impl::Impl(void* native_handle, bool drop) :
 Context::Impl::~Impl()
 {
     device.Wait();
+    device.GetDeletionQueue().Flush();
 }
 
 void Context::Impl::CreateSwapchain()
@@ -367,6 +578,8 @@ void Context::Impl::CreateDescriptorLayout()
     descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::TEXTURE2D)] = CreateTexture2DLayout(device);
     descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::TEXTURE3D)] = CreateTexture3DLayout(device);
     descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::TEXT)] = CreateTextLayout(device);
+
+    if (device.SupportsBindless()) bindless_textures = BindlessTextures(physical_device, device);
 }
 
 void Context::Impl::CreatePipelines()
@@ -385,6 +598,24 @@ void Context::Impl::CreatePipelines()
 
     graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXT)] = CreateTextPipeline(physical_device, device, render_pass, swapchain,
         descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::TEXT)], msaa);
+
+    graphics_pipelines[static_cast<size_t>(GraphicsPipelines::COLOR3D_INSTANCED)] = CreateColor3DInstancedPipeline(physical_device, device,
+        render_pass, swapchain, descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::COLOR3D)], msaa);
+
+    graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXTURE3D_INSTANCED)] = CreateTexture3DInstancedPipeline(physical_device, device,
+        render_pass, swapchain, descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::TEXTURE3D)], msaa);
+
+    if (!UsesBindlessTextures()) return;
+
+    graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXTURE2D_BINDLESS)] = CreateTexture2DBindlessPipeline(physical_device, device,
+        render_pass, swapchain, bindless_textures.GetLayout(), msaa);
+
+    graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXTURE3D_BINDLESS)] = CreateTexture3DBindlessPipeline(physical_device, device,
+        render_pass, swapchain, descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::COLOR3D)], bindless_textures.GetLayout(), msaa);
+
+    graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXTURE3D_INSTANCED_BINDLESS)] = CreateTexture3DInstancedBindlessPipeline(
+        physical_device, device, render_pass, swapchain, descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::COLOR3D)],
+        bindless_textures.GetLayout(), msaa);
 }
 
 void Context::Impl::CreateCommandPool()
@@ -403,23 +634,84 @@ void Context::Impl::CreateUniformBuffers()
 {
     assert(uniform_buffers.size() == uniform_buffers_mapped.size());
     for (size_t i = 0; i < uniform_buffers.size(); ++i) {
-        uniform_buffers[i] = Buffer(physical_device, device.Get(), sizeof(CameraView), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, VK_SHARING_MODE_EXCLUSIVE); // FIX THIS
-        vkMapMemory(device.Get(), uniform_buffers[i].GetMemory(), 0, sizeof(CameraView), 0, &uniform_buffers_mapped[i]);
+        uniform_buffers[i] = Buffer(device, sizeof(CameraView), VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, MemoryUsage::DYNAMIC);
+        uniform_buffers_mapped[i] = uniform_buffers[i].GetMapped();
     }
 
+    for (auto& c : camera_uniforms) c = UniformRing(physical_device, device, sizeof(glm::mat4));
+
     const glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(swapchain.GetWidth()), static_cast<float>(swapchain.GetHeight()), 0.0f);
     // projection[1][1] *= -1;
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
         memcpy(uniform_buffers_mapped[static_cast<size_t>(UniformBuffers::TEXT_PROJECTION) * MAX_FRAMES_IN_FLIGHT + i], &projection, sizeof(projection));
 }
 
+void Context::Impl::CreateGeometryBuffers()
+{
+    for (auto& g : geometry_buffers)
+        g = RingBuffer(physical_device, device, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT |
+            VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT);
+
+    // A unit cube in the vertex layout of the 3D texture pipeline (position, texture coordinates)
+    constexpr std::array<float, 20 * 6> cube_vertices = {
+        // Front
+        0.0f, 0.0f, 0.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+
+        // Back
+        0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+
+        // Top
+        0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
+
+        // Bottom
+        0.0f, 1.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 0.0f, 0.0f, 0.0f,
+
+        // Left
+        0.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+        0.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+        0.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+        0.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+
+        // Right
+        1.0f, 0.0f, 1.0f, 0.0f, 1.0f,
+        1.0f, 0.0f, 0.0f, 1.0f, 1.0f,
+        1.0f, 1.0f, 0.0f, 1.0f, 0.0f,
+        1.0f, 1.0f, 1.0f, 0.0f, 0.0f,
+    };
+
+    constexpr std::array<uint32_t, 36> cube_indices = {
+        0, 1, 2, 2, 3, 0,       // Front
+        4, 5, 6, 6, 7, 4,       // Back
+        8, 9, 10, 10, 11, 8,    // Top
+        12, 13, 14, 14, 15, 12, // Bottom
+        16, 17, 18, 18, 19, 16, // Left
+        20, 21, 22, 22, 23, 20, // Right
+    };
+
+    cube_mesh = MeshBuffer(device, cube_vertices, cube_indices);
+    sprite_batch = SpriteBatch(physical_device, device);
+    rect_batch = RectBatch(device);
+    scene = RetainedScene(device);
+}
+
 void Context::Impl::CreateDescriptorPool()
 {
     const std::array<VkDescriptorPoolSize, 2> pool_sizes = {
         VkDescriptorPoolSize {
-            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 3
+            .type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+            .descriptorCount = 200 // The camera of the Color3D sets and of every texture's Texture3D sets
         },
         VkDescriptorPoolSize {
             .type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
@@ -432,11 +724,9 @@ void Context::Impl::CreateDescriptorPool()
 
 void Context::Impl::CreateBuiltinDescriptorSets()
 {
-    const auto color3d_set = CreateColor3DSet(device, descriptor_pool, descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::COLOR3D)],
-        { &uniform_buffers[static_cast<size_t>(UniformBuffers::COLOR3D) * MAX_FRAMES_IN_FLIGHT], MAX_FRAMES_IN_FLIGHT });
-
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-        color_sets[i] = color3d_set;
+        color_sets[i] = CreateColor3DSet(device, descriptor_pool, descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::COLOR3D)],
+            camera_uniforms[i].GetBuffer(), camera_uniforms[i].GetElementSize());
     }
 }
 
@@ -445,6 +735,9 @@ void Context::Impl::CreateCommandBuffers()
     command_buffers.resize(MAX_FRAMES_IN_FLIGHT);
 
     for (auto& c : command_buffers) c = CommandBuffer(device.Get(), command_pool.Get(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
+
+    cull_command_buffers.resize(MAX_FRAMES_IN_FLIGHT);
+    for (auto& c : cull_command_buffers) c = CommandBuffer(device.Get(), command_pool.Get(), VK_COMMAND_BUFFER_LEVEL_PRIMARY);
 }
 
 void Context::Impl::CreateSyncObjects()
@@ -469,15 +762,20 @@ void Context::Impl::RecreateSwapChain()
         SDL_WaitEvent(nullptr);
     }
 
-    vkDeviceWaitIdle(device.Get());
-
+    // Frames in flight may still be rendering to the old swapchain's attachments, so it is destroyed once they have finished instead
+    // of idling the device
+    Swapchain old_swapchain = std::move(swapchain);
     swapchain = Swapchain(physical_device, device, command_pool, surface, window, render_pass,
         ChooseSurfaceFormat(physical_device, surface.Get()), VK_PRESENT_MODE_FIFO_KHR, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
-        VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR, VK_TRUE, msaa, swapchain.Get());
+        VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR, VK_TRUE, msaa, old_swapchain.Get());
+    device.GetDeletionQueue().Defer(std::move(old_swapchain));
 
     const glm::mat4 projection = glm::ortho(0.0f, static_cast<float>(swapchain.GetWidth()), static_cast<float>(swapchain.GetHeight()), 0.0f);
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
         memcpy(uniform_buffers_mapped[static_cast<size_t>(UniformBuffers::TEXT_PROJECTION) * MAX_FRAMES_IN_FLIGHT + i], &projection, sizeof(projection));
+
+    // Relative text is laid out for the swapchain extent
+    scene.InvalidateText();
 }
 
 bool Context::Impl::BeginRendering()
@@ -495,11 +793,13 @@ bool Context::Impl::BeginRendering()
 
     in_flight_fences[current_frame].Reset();
 
-    current_buffer_positions[current_frame] = 0;
-    /*vertex_buffers[current_frame].clear();
-    index_buffers[current_frame].clear();
-    vertex_staging_buffers[current_frame].clear();
-    index_staging_buffers[current_frame].clear();*/
+    // The fence has signalled, so the GPU is done with everything this slot's previous frame used
+    geometry_buffers[current_frame].Reset();
+    camera_uniforms[current_frame].Reset();
+    device.GetDeletionQueue().Collect(submitted_frames[current_frame]);
+    device.GetUploadQueue().Collect();
+    if (culler.IsCreated()) culler.BeginFrame(current_frame);
+    culling_recorded = false;
 
     vkResetCommandBuffer(command_buffers[current_frame].GetBuffer(), 0);
     const VkCommandBufferBeginInfo begin_info = {
@@ -526,8 +826,24 @@ bool Context::Impl::BeginRendering()
         .pClearValues = clear_colors.data()
     };
 
-    vkCmdBeginRenderPass(command_buffers[current_frame].GetBuffer(), &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+    // A subpass is recorded either inline or entirely in secondary command buffers
+    if (recorder) {
+        vkCmdBeginRenderPass(command_buffers[current_frame].GetBuffer(), &render_pass_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+        recorder->BeginFrame(current_frame);
+        BeginSecondary();
+    }
+    else {
+        vkCmdBeginRenderPass(command_buffers[current_frame].GetBuffer(), &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+        recording = &command_buffers[current_frame];
+        binds.Begin(recording->GetBuffer());
+        SetViewportAndScissor(binds);
+    }
 
+    return true;
+}
+
+void Context::Impl::SetViewportAndScissor(BindCache& binds) const noexcept
+{
     const VkViewport viewport = {
         .x = 0.0f,
         .y = 0.0f,
@@ -536,42 +852,125 @@ bool Context::Impl::BeginRendering()
         .minDepth = 0.0f,
         .maxDepth = 1.0f
     };
-    vkCmdSetViewport(command_buffers[current_frame].GetBuffer(), 0, 1, &viewport);
+    binds.SetViewport(viewport);
 
     const VkRect2D scissor = {
         .offset = { 0, 0 },
         .extent = swapchain.GetExtent()
     };
-    vkCmdSetScissor(command_buffers[current_frame].GetBuffer(), 0, 1, &scissor);
+    binds.SetScissor(scissor);
+}
 
-    return true;
+VkCommandBufferInheritanceInfo Context::Impl::GetInheritanceInfo() noexcept
+{
+    return VkCommandBufferInheritanceInfo {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+        .renderPass = render_pass.Get(),
+        .subpass = 0,
+        .framebuffer = swapchain.GetFramebuffers()[image_index].Get()
+    };
+}
+
+VkCommandBuffer Context::Impl::BeginCulling()
+{
+    const VkCommandBuffer command_buffer = cull_command_buffers[current_frame].GetBuffer();
+    if (culling_recorded) return command_buffer;
+
+    vkResetCommandBuffer(command_buffer, 0);
+    const VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = nullptr
+    };
+
+    const auto result = vkBeginCommandBuffer(command_buffer, &begin_info);
+    if (result != VK_SUCCESS) ThrowError("Failed to begin recording cull command buffer.", result);
+
+    culling_recorded = true;
+    return command_buffer;
+}
+
+void Context::Impl::BeginSecondary()
+{
+    recording = &recorder->BeginSecondary(GetInheritanceInfo());
+    binds.Begin(recording->GetBuffer());
+
+    // Secondary command buffers inherit no state, not even the dynamic state of the primary one
+    SetViewportAndScissor(binds);
+}
+
+void Context::Impl::EndSecondary()
+{
+    recording->End();
+    secondaries.push_back(recording->GetBuffer());
+}
+
+void Context::Impl::SetRecordingThreads(uint32_t count)
+{
+    // The command buffers of the frames in flight belong to the current recorder's pools
+    device.Wait();
+    recorder = count > 1 ? std::make_unique<ParallelRecorder>(device, count) : nullptr;
+}
+
+void Context::Impl::SetGPUCulling(bool enabled)
+{
+    // The culling pipeline is only created once culling is first turned on
+    if (enabled && !culler.IsCreated()) culler = IndirectCuller(physical_device, device);
+    gpu_culling = enabled;
 }
 
 void Context::Impl::EndRendering()
 {
+    if (!draw_list.Empty()) ExecuteDrawList();
+    FlushBatches();
+
+    if (recorder) {
+        EndSecondary();
+        vkCmdExecuteCommands(command_buffers[current_frame].GetBuffer(), static_cast<uint32_t>(secondaries.size()), secondaries.data());
+        secondaries.clear();
+    }
+
     vkCmdEndRenderPass(command_buffers[current_frame].GetBuffer());
 
+    last_stats = binds.GetStats();
+    last_stats += parallel_stats;
+    binds.ResetStats();
+    parallel_stats = {};
+
     const auto buf_result = vkEndCommandBuffer(command_buffers[current_frame].GetBuffer());
     if (buf_result != VK_SUCCESS) ThrowError("Failed to record command buffer.", buf_result);
 
+    // The culling runs first in the same submission, so the barrier at its end covers the draws that read its results
+    const std::array<VkCommandBuffer, 2> submitted = { cull_command_buffers[current_frame].GetBuffer(), command_buffers[current_frame].GetBuffer() };
+    const std::span<const VkCommandBuffer> cbs = culling_recorded ? std::span(submitted) : std::span(submitted).subspan(1);
+
+    if (culling_recorded) {
+        IndirectCuller::Barrier(submitted[0]);
+        const auto cull_result = vkEndCommandBuffer(submitted[0]);
+        if (cull_result != VK_SUCCESS) ThrowError("Failed to record cull command buffer.", cull_result);
+    }
+
+    // Submit the uploads recorded during this frame (buffer writes, texture loads) ahead of the frame that reads them
+    device.GetUploadQueue().Flush();
+
     const auto img_av_s = image_available_semaphores[current_frame].Get();
     const auto ren_fin_s = render_finished_semaphores[current_frame].Get();
 
     const std::array<VkPipelineStageFlags, 1> wait_stages = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-    const auto cb = command_buffers[current_frame].GetBuffer();
     const VkSubmitInfo submit_info = {
         .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
         .waitSemaphoreCount = 1,
         .pWaitSemaphores = &img_av_s,
         .pWaitDstStageMask = wait_stages.data(),
-        .commandBufferCount = 1,
-        .pCommandBuffers = &cb,
+        .commandBufferCount = static_cast<uint32_t>(cbs.size()),
+        .pCommandBuffers = cbs.data(),
         .signalSemaphoreCount = 1,
         .pSignalSemaphores = &ren_fin_s
     };
 
     const auto submit_result = vkQueueSubmit(device.GetGraphicsQueue(), 1, &submit_info, in_flight_fences[current_frame].Get());
     if (submit_result != VK_SUCCESS) ThrowError("Failed to submit draw command buffer.", submit_result);
+    submitted_frames[current_frame] = device.GetDeletionQueue().EndFrame();
 
     const auto sc = swapchain.Get();
     const VkPresentInfoKHR present_info = {
@@ -593,193 +992,212 @@ void Context::Impl::EndRendering()
         ThrowError("Failed to present queue.", present_result);
 
     current_frame = (current_frame + 1) % MAX_FRAMES_IN_FLIGHT;
-    for (auto& a : alphabets) a.ClearBuffers(current_frame);
 }
 
-// TO DO: Optimise this function
 void Context::Impl::Render2D(size_t texture, Rect dst)
 {
-    const std::array<float, 20> vertices = {
-        dst.x,          dst.y,          0.0f, 0.0f, 0.0f,
-        dst.x + dst.w,  dst.y,          0.0f, 1.0f, 0.0f,
-        dst.x + dst.w,  dst.y + dst.h,  0.0f, 1.0f, 1.0f,
-        dst.x,          dst.y + dst.h,  0.0f, 0.0f, 1.0f
-    };
-
-    static constexpr std::array<uint32_t, 6> indices = {
-        0, 1, 2, 2, 3, 0
-    };
+    Render2D(texture, Rect{ 0.0f, 0.0f, 1.0f, 1.0f }, dst);
+}
 
-    auto& bufpos = current_buffer_positions[current_frame];
-    auto& vbufferarr = vertex_buffers[current_frame];
-    auto& vbufferstaging = vertex_staging_buffers[current_frame];
-    auto& ibufferarr = index_buffers[current_frame];
-    auto& ibufferstaging = index_staging_buffers[current_frame];
-    if (bufpos >= vbufferarr.size() || vbufferarr.size() == 0) {
-        vbufferarr.push_back(Buffer::CreateVertexBuffer(physical_device, device, command_pool, vertices));
-        vbufferstaging.push_back(CreateStagingBuffer(physical_device, device.Get(), sizeof(vertices)));
-        ibufferarr.push_back(Buffer::CreateIndexBuffer(physical_device, device, command_pool, indices));
-        ibufferstaging.push_back(CreateStagingBuffer(physical_device, device.Get(), sizeof(indices)));
-    }
-    else {
-        vbufferarr[bufpos].WriteData(device, command_pool, vbufferstaging[bufpos], vertices.data(), sizeof(vertices));
-        ibufferarr[bufpos].WriteData(device, command_pool, ibufferstaging[bufpos], indices.data(), sizeof(indices));
+void Context::Impl::Render2D(size_t texture, Rect src, Rect dst)
+{
+    if (deferred_rendering) {
+        Defer(DeferredDraw{ .type = DeferredDraw::Type::SPRITE, .texture = texture, .rect = dst, .src = src }, GraphicsPipelines::TEXTURE2D,
+            0.0f);
     }
+    else RecordSprite(texture, src, dst);
+}
 
-    vkCmdBindPipeline(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::TEXTURE2D)].GetPipeline());
-    const auto buf = vbufferarr[bufpos].GetBuffer();
-
-    const VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(command_buffers[current_frame].GetBuffer(), 0, 1, &buf, &offset);
-    vkCmdBindIndexBuffer(command_buffers[current_frame].GetBuffer(), ibufferarr[bufpos].GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+void Context::Impl::Color2D(Color color, Rect area)
+{
+    if (deferred_rendering) Defer(DeferredDraw{ .type = DeferredDraw::Type::RECT, .texture = 0, .color = color, .rect = area }, GraphicsPipelines::COLOR2D, 0.0f);
+    else RecordRect(color, area);
+}
 
-    vkCmdBindDescriptorSets(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::TEXTURE2D)].GetLayout(), 0, 1, &texture_sets_2d[texture * 2 + current_frame], 0, nullptr);
+// How far below y the first row of text of this size starts, for its vertical alignment
+static float GetTextSizeOffset(float size, VerticalAlignment valign) noexcept
+{
+    switch (valign) {
+    case VerticalAlignment::TOP: break;
+    case VerticalAlignment::CENTER: return 0.0f;
+    case VerticalAlignment::BOTTOM: return -size;
+    }
 
-    vkCmdDrawIndexed(command_buffers[current_frame].GetBuffer(), static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
-    ++bufpos;
+    return size;
 }
 
-void Context::Impl::Render2D(size_t texture, Rect src, Rect dst)
+// The distance of a point in model space from the camera
+static float ViewDistance(const CameraView& camera, glm::vec3 point)
 {
-    (void)texture, src, dst;
+    return glm::length(glm::vec3(camera.view * camera.model * glm::vec4(point, 1.0f)));
 }
 
-void Context::Impl::Color2D(Color color, Rect area)
+void Context::Impl::Render3D(size_t texture, Cuboid area, const CameraView& camera)
 {
-    const std::array<float, 28> vertices = {
-        area.x,          area.y,          0.0f, color.r, color.g, color.b, color.a,
-        area.x + area.w, area.y,          0.0f, color.r, color.g, color.b, color.a,
-        area.x + area.w, area.y + area.h, 0.0f, color.r, color.g, color.b, color.a,
-        area.x,          area.y + area.h, 0.0f, color.r, color.g, color.b, color.a
-    };
+    if (!deferred_rendering) {
+        if (!GetFrustum(camera).Intersects(area)) return;
+        const Draw3D draw = PrepareTexturedCuboid(texture, area, camera);
+        RecordDraws3D({ &draw, 1 });
+        return;
+    }
 
-    static constexpr std::array<uint32_t, 6> indices = {
-        0, 1, 2, 2, 3, 0
-    };
+    const glm::vec3 center(area.x + area.w / 2.0f, area.y + area.h / 2.0f, area.z + area.d / 2.0f);
+    Defer(DeferredDraw{ .type = DeferredDraw::Type::TEXTURED_CUBOID, .texture = texture, .cuboid = area, .camera = DeferCamera(camera) },
+        GraphicsPipelines::TEXTURE3D, ViewDistance(camera, center));
+}
 
-    /*vertex_buffers[current_frame].push_back(Buffer::CreateVertexBuffer(physical_device, device, command_pool, vertices));
-    index_buffers[current_frame].push_back(Buffer::CreateIndexBuffer(physical_device, device, command_pool, indices));*/
-    auto& bufpos = current_buffer_positions[current_frame];
-    auto& vbufferarr = vertex_buffers[current_frame];
-    auto& vbufferstaging = vertex_staging_buffers[current_frame];
-    auto& ibufferarr = index_buffers[current_frame];
-    auto& ibufferstaging = index_staging_buffers[current_frame];
-    if (bufpos >= vbufferarr.size() || vbufferarr.size() == 0) {
-        vbufferarr.push_back(Buffer::CreateVertexBuffer(physical_device, device, command_pool, vertices));
-        vbufferstaging.push_back(CreateStagingBuffer(physical_device, device.Get(), sizeof(vertices)));
-        ibufferarr.push_back(Buffer::CreateIndexBuffer(physical_device, device, command_pool, indices));
-        ibufferstaging.push_back(CreateStagingBuffer(physical_device, device.Get(), sizeof(indices)));
-    }
-    else {
-        const VkDeviceSize vsize = sizeof(vertices);
-        const VkDeviceSize isize = sizeof(indices); // TO DO: Fix this code, has buffer overflow
-        vbufferarr[bufpos].WriteData(device, command_pool, vbufferstaging[bufpos], vertices.data(), sizeof(vertices));
-        ibufferarr[bufpos].WriteData(device, command_pool, ibufferstaging[bufpos], indices.data(), sizeof(indices));
+void Context::Impl::Render3D(size_t texture, const Model& model, const CameraView& camera)
+{
+    if (!deferred_rendering) {
+        if (!GetFrustum(camera).Intersects(model.GetBoundsMin(), model.GetBoundsMax())) return;
+        const Draw3D draw = PrepareTexturedModel(texture, model, camera);
+        RecordDraws3D({ &draw, 1 });
+        return;
     }
 
-    vkCmdBindPipeline(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::COLOR2D)].GetPipeline());
-    const auto buf = vertex_buffers[current_frame].back().GetBuffer();
+    Defer(DeferredDraw{ .type = DeferredDraw::Type::TEXTURED_MODEL, .texture = texture, .model = &model, .camera = DeferCamera(camera) },
+        GraphicsPipelines::TEXTURE3D, ViewDistance(camera, (model.GetBoundsMin() + model.GetBoundsMax()) / 2.0f));
+}
 
-    const VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(command_buffers[current_frame].GetBuffer(), 0, 1, &buf, &offset);
-    vkCmdBindIndexBuffer(command_buffers[current_frame].GetBuffer(), index_buffers[current_frame].back().GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+void Context::Impl::Color3D(Color color, Cuboid area, const CameraView& camera)
+{
+    if (!deferred_rendering) {
+        if (!GetFrustum(camera).Intersects(area)) return;
+        const Draw3D draw = PrepareColoredCuboid(color, area, camera);
+        RecordDraws3D({ &draw, 1 });
+        return;
+    }
 
-    vkCmdDrawIndexed(command_buffers[current_frame].GetBuffer(), static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+    const glm::vec3 center(area.x + area.w / 2.0f, area.y + area.h / 2.0f, area.z + area.d / 2.0f);
+    Defer(DeferredDraw{ .type = DeferredDraw::Type::COLORED_CUBOID, .texture = 0, .color = color, .cuboid = area, .camera = DeferCamera(camera) },
+        GraphicsPipelines::COLOR3D, ViewDistance(camera, center));
 }
 
-void Context::Impl::Render3D(size_t texture, Cuboid area, const CameraView& camera)
+void Context::Impl::Color3DInstanced(std::span<const Instance3D> instances, const CameraView& camera)
 {
-    const std::array<float, 20 * 6> vertices = {
-        // Front
-        area.x,          area.y,          area.z,          0.0f, 1.0f,
-        area.x + area.w, area.y,          area.z,          1.0f, 1.0f,
-        area.x + area.w, area.y + area.h, area.z,          1.0f, 0.0f,
-        area.x,          area.y + area.h, area.z,          0.0f, 0.0f,
+    DrawInstanced(GraphicsPipelines::COLOR3D_INSTANCED, 0, nullptr, instances, camera);
+}
 
-        // Back
-        area.x,          area.y,          area.z + area.d, 0.0f, 1.0f,
-        area.x + area.w, area.y,          area.z + area.d, 1.0f, 1.0f,
-        area.x + area.w, area.y + area.h, area.z + area.d, 1.0f, 0.0f,
-        area.x,          area.y + area.h, area.z + area.d, 0.0f, 0.0f,
+void Context::Impl::Render3DInstanced(size_t texture, std::span<const Instance3D> instances, const CameraView& camera)
+{
+    DrawInstanced(GraphicsPipelines::TEXTURE3D_INSTANCED, texture, nullptr, instances, camera);
+}
 
-        // Top
-        area.x,          area.y,          area.z + area.d, 0.0f, 1.0f,
-        area.x + area.w, area.y,          area.z + area.d, 1.0f, 1.0f,
-        area.x + area.w, area.y,          area.z,          1.0f, 0.0f,
-        area.x,          area.y,          area.z,          0.0f, 0.0f,
+void Context::Impl::Render3DInstanced(size_t texture, const Model& model, std::span<const Instance3D> instances, const CameraView& camera)
+{
+    DrawInstanced(GraphicsPipelines::TEXTURE3D_INSTANCED, texture, &model, instances, camera);
+}
 
-        // Bottom
-        area.x,          area.y + area.h, area.z + area.d, 0.0f, 1.0f,
-        area.x + area.w, area.y + area.h, area.z + area.d, 1.0f, 1.0f,
-        area.x + area.w, area.y + area.h, area.z,          1.0f, 0.0f,
-        area.x,          area.y + area.h, area.z,          0.0f, 0.0f,
+void Context::Impl::DrawInstanced(GraphicsPipelines pipeline, size_t texture, const Model* model, std::span<const Instance3D> instances,
+    const CameraView& camera)
+{
+    if (instances.empty()) return;
 
-        // Left
-        area.x,          area.y,          area.z + area.d, 0.0f, 1.0f,
-        area.x,          area.y,          area.z,          1.0f, 1.0f,
-        area.x,          area.y + area.h, area.z,          1.0f, 0.0f,
-        area.x,          area.y + area.h, area.z + area.d, 0.0f, 0.0f,
+    // The geometry buffer is only reset once the frame has finished executing, so deferred draws can keep the range until EndRendering
+    const auto range = geometry_buffers[current_frame].Push(instances.data(), instances.size_bytes(), sizeof(float));
+    const auto count = static_cast<uint32_t>(instances.size());
 
-        // Right
-        area.x + area.w, area.y,          area.z + area.d, 0.0f, 1.0f,
-        area.x + area.w, area.y,          area.z,          1.0f, 1.0f,
-        area.x + area.w, area.y + area.h, area.z,          1.0f, 0.0f,
-        area.x + area.w, area.y + area.h, area.z + area.d, 0.0f, 0.0f,
-    };
+    if (!deferred_rendering) {
+        const Draw3D draw = PrepareInstanced(pipeline, texture, model != nullptr ? model->GetMeshBuffer(device) : cube_mesh, range, count, camera);
+        RecordDraws3D({ &draw, 1 });
+        return;
+    }
 
-    const std::array<uint32_t, 36> indices = {
-        0, 1, 2, 2, 3, 0,       // Front
-        4, 5, 6, 6, 7, 4,       // Back
-        8, 9, 10, 10, 11, 8,    // Left
-        12, 13, 14, 14, 15, 12, // Right
-        16, 17, 18, 18, 19, 16, // Top
-        20, 21, 22, 22, 23, 20, // Bottom
-    };
+    // The draw sorts by its nearest instance, where the center of the mesh ends up after the instance's transform
+    const glm::vec3 center = model != nullptr ? (model->GetBoundsMin() + model->GetBoundsMax()) / 2.0f : glm::vec3(0.5f);
+    float depth = std::numeric_limits<float>::max();
+    for (const Instance3D& instance : instances)
+        depth = std::min(depth, ViewDistance(camera, glm::vec3(instance.transform * glm::vec4(center, 1.0f))));
 
-    vertex_buffers[current_frame].push_back(Buffer::CreateVertexBuffer(physical_device, device, command_pool, vertices));
-    index_buffers[current_frame].push_back(Buffer::CreateIndexBuffer(physical_device, device, command_pool, indices));
+    Defer(DeferredDraw{ .type = DeferredDraw::Type::INSTANCED, .texture = texture, .model = model, .camera = DeferCamera(camera),
+        .pipeline = pipeline, .instances = range, .instance_count = count }, pipeline, depth);
+}
 
-    vkCmdBindPipeline(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::TEXTURE3D)].GetPipeline());
+Context::Impl::Draw3D Context::Impl::PrepareTransform(GraphicsPipelines pipeline, VkDescriptorSet set, const CameraView& camera,
+    const glm::mat4& model)
+{
+    const auto& p = graphics_pipelines[static_cast<size_t>(pipeline)];
+    const glm::mat4 view_proj = camera.proj * camera.view;
+
+    return Draw3D {
+        .pipeline = p.GetPipeline(),
+        .layout = p.GetLayout(),
+        .set = set,
+        .camera_offset = camera_uniforms[current_frame].Push(&view_proj),
+        .model = model,
+        .texture_array = nullptr,
+        .texture_index = 0,
+        .mesh = nullptr,
+        .vertices = {}, .indices = {},
+        .index_count = 0,
+        .instances = {},
+        .instance_count = 0,
+        .indirect = {},
+        .indirect_count = {}
+    };
+}
 
-    const auto vertex_buffer = vertex_buffers[current_frame].back().GetBuffer();
-    const VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(command_buffers[current_frame].GetBuffer(), 0, 1, &vertex_buffer, &offset);
-    vkCmdBindIndexBuffer(command_buffers[current_frame].GetBuffer(), index_buffers[current_frame].back().GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+Context::Impl::Draw3D Context::Impl::PrepareTextured(GraphicsPipelines pipeline, size_t texture, const CameraView& camera,
+    const glm::mat4& model)
+{
+    if (!UsesBindlessTextures()) return PrepareTransform(pipeline, texture_sets_3d[texture * MAX_FRAMES_IN_FLIGHT + current_frame], camera, model);
 
-    vkCmdBindDescriptorSets(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::TEXTURE3D)].GetLayout(), 0, 1, &texture_sets_3d[texture * MAX_FRAMES_IN_FLIGHT + current_frame], 0, nullptr);
+    // The bindless pipelines read the camera from the camera only set of the frame and the texture from the array
+    const GraphicsPipelines bindless = pipeline == GraphicsPipelines::TEXTURE3D ? GraphicsPipelines::TEXTURE3D_BINDLESS :
+        GraphicsPipelines::TEXTURE3D_INSTANCED_BINDLESS;
 
-    memcpy(uniform_buffers_mapped[static_cast<size_t>(UniformBuffers::TEXTURE3D) * 2 + current_frame], &camera, sizeof(CameraView));
+    Draw3D draw = PrepareTransform(bindless, color_sets[current_frame], camera, model);
+    draw.texture_array = bindless_textures.GetSet();
+    draw.texture_index = static_cast<uint32_t>(texture);
+    return draw;
+}
 
-    vkCmdDrawIndexed(command_buffers[current_frame].GetBuffer(), static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+Context::Impl::Draw3D Context::Impl::PrepareInstanced(GraphicsPipelines pipeline, size_t texture, const MeshBuffer& mesh, RingBuffer::Range instances,
+    uint32_t instance_count, const CameraView& camera)
+{
+    Draw3D draw = pipeline == GraphicsPipelines::TEXTURE3D_INSTANCED ? PrepareTextured(pipeline, texture, camera, camera.model) :
+        PrepareTransform(pipeline, color_sets[current_frame], camera, camera.model);
+    draw.mesh = &mesh;
+    draw.index_count = mesh.GetIndexCount();
+    draw.instances = instances;
+    draw.instance_count = instance_count;
+    return draw;
 }
 
-void Context::Impl::Render3D(size_t texture, const Model& model, const CameraView& camera)
+void Context::Impl::RecordSprite(size_t texture, Rect src, Rect dst)
 {
-    vertex_buffers[current_frame].push_back(Buffer::CreateVertexBuffer(physical_device, device, command_pool, model.GetVertices()));
-    index_buffers[current_frame].push_back(Buffer::CreateIndexBuffer(physical_device, device, command_pool, model.GetIndices()));
+    FlushRects();
+    sprite_batch.Add(texture, dst, src);
+}
 
-    vkCmdBindPipeline(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::TEXTURE3D)].GetPipeline());
+void Context::Impl::RecordRect(Color color, Rect area)
+{
+    FlushSprites();
+    rect_batch.Add(color, area);
+}
 
-    const auto vertex_buffer = vertex_buffers[current_frame].back().GetBuffer();
-    const VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(command_buffers[current_frame].GetBuffer(), 0, 1, &vertex_buffer, &offset);
-    vkCmdBindIndexBuffer(command_buffers[current_frame].GetBuffer(), index_buffers[current_frame].back().GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+Context::Impl::Draw3D Context::Impl::PrepareTexturedCuboid(size_t texture, Cuboid area, const CameraView& camera)
+{
+    // The cube mesh spans (0, 0, 0) to (1, 1, 1), so it is stretched over the area by the model matrix
+    const glm::mat4 model = glm::scale(glm::translate(camera.model, glm::vec3(area.x, area.y, area.z)), glm::vec3(area.w, area.h, area.d));
 
-    vkCmdBindDescriptorSets(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::TEXTURE3D)].GetLayout(), 0, 1, &texture_sets_3d[texture * MAX_FRAMES_IN_FLIGHT + current_frame], 0, nullptr);
+    Draw3D draw = PrepareTextured(GraphicsPipelines::TEXTURE3D, texture, camera, model);
+    draw.mesh = &cube_mesh;
+    draw.index_count = cube_mesh.GetIndexCount();
+    return draw;
+}
 
-    memcpy(uniform_buffers_mapped[static_cast<size_t>(UniformBuffers::TEXTURE3D) * 2 + current_frame], &camera, sizeof(CameraView));
+Context::Impl::Draw3D Context::Impl::PrepareTexturedModel(size_t texture, const Model& model, const CameraView& camera)
+{
+    const MeshBuffer& mesh = model.GetMeshBuffer(device);
 
-    vkCmdDrawIndexed(command_buffers[current_frame].GetBuffer(), static_cast<uint32_t>(model.GetIndices().size()), 1, 0, 0, 0);
+    Draw3D draw = PrepareTextured(GraphicsPipelines::TEXTURE3D, texture, camera, camera.model);
+    draw.mesh = &mesh;
+    draw.index_count = mesh.GetIndexCount();
+    return draw;
 }
 
-void Context::Impl::Color3D(Color color, Cuboid area, const CameraView& camera)
+Context::Impl::Draw3D Context::Impl::PrepareColoredCuboid(Color color, Cuboid area, const CameraView& camera)
 {
     const std::array<float, 56> vertices = {
         // Front
@@ -795,7 +1213,7 @@ void Context::Impl::Color3D(Color color, Cuboid area, const CameraView& camera)
         area.x,          area.y + area.h, area.z + area.d, color.r, color.g, color.b, color.a
     };
 
-    const std::array<uint32_t, 36> indices = {
+    static constexpr std::array<uint32_t, 36> indices = {
         0, 1, 2, 2, 3, 0, // Front
         4, 5, 6, 6, 7, 4, // Back
         4, 0, 3, 3, 7, 4, // Left
@@ -804,63 +1222,415 @@ void Context::Impl::Color3D(Color color, Cuboid area, const CameraView& camera)
         7, 6, 2, 2, 3, 7, // Bottom
     };
 
-    vertex_buffers[current_frame].push_back(Buffer::CreateVertexBuffer(physical_device, device, command_pool, vertices));
-    index_buffers[current_frame].push_back(Buffer::CreateIndexBuffer(physical_device, device, command_pool, indices));
+    auto& geometry = geometry_buffers[current_frame];
+
+    Draw3D draw = PrepareTransform(GraphicsPipelines::COLOR3D, color_sets[current_frame], camera, camera.model);
+    draw.vertices = geometry.Push(vertices.data(), sizeof(vertices), sizeof(float));
+    draw.indices = geometry.Push(indices.data(), sizeof(indices), sizeof(uint32_t));
+    draw.index_count = static_cast<uint32_t>(indices.size());
+    return draw;
+}
+
+Context::Impl::Draw3D Context::Impl::PrepareDeferred(const DeferredDraw& draw)
+{
+    const CameraView& camera = deferred_cameras[draw.camera];
+
+    switch (draw.type) {
+    case DeferredDraw::Type::TEXTURED_CUBOID: return PrepareTexturedCuboid(draw.texture, draw.cuboid, camera);
+    case DeferredDraw::Type::TEXTURED_MODEL: return PrepareTexturedModel(draw.texture, *draw.model, camera);
+    case DeferredDraw::Type::COLORED_CUBOID: return PrepareColoredCuboid(draw.color, draw.cuboid, camera);
+    default:
+        return PrepareInstanced(draw.pipeline, draw.texture, draw.model != nullptr ? draw.model->GetMeshBuffer(device) : cube_mesh, draw.instances,
+            draw.instance_count, camera);
+    }
+}
 
-    vkCmdBindPipeline(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS,
-        graphics_pipelines[static_cast<size_t>(GraphicsPipelines::COLOR3D)].GetPipeline());
+void Context::Impl::RecordDraw3D(BindCache& binds, const Draw3D& draw) noexcept
+{
+    const VkCommandBuffer command_buffer = binds.Get();
+
+    binds.BindPipeline(draw.pipeline);
+    binds.BindDescriptorSet(draw.layout, 0, draw.set, std::span(&draw.camera_offset, 1));
 
-    const auto buf = vertex_buffers[current_frame].back().GetBuffer();
-    const VkDeviceSize offset = 0;
-    vkCmdBindVertexBuffers(command_buffers[current_frame].GetBuffer(), 0, 1, &buf, &offset);
-    vkCmdBindIndexBuffer(command_buffers[current_frame].GetBuffer(), index_buffers[current_frame].back().GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
-    vkCmdBindDescriptorSets(command_buffers[current_frame].GetBuffer(), VK_PIPELINE_BIND_POINT_GRAPHICS, graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::COLOR3D)].GetLayout(), 0, 1, &color_sets[current_frame],
-        0, nullptr);
+    if (draw.texture_array != nullptr) {
+        binds.BindDescriptorSet(draw.layout, 1, draw.texture_array);
+        vkCmdPushConstants(command_buffer, draw.layout, VK_SHADER_STAGE_FRAGMENT_BIT, sizeof(glm::mat4), sizeof(uint32_t), &draw.texture_index);
+    }
 
-    memcpy(uniform_buffers_mapped[static_cast<size_t>(UniformBuffers::COLOR3D) * 2 + current_frame], &camera, sizeof(CameraView));
+    vkCmdPushConstants(command_buffer, draw.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &draw.model);
 
-    vkCmdDrawIndexed(command_buffers[current_frame].GetBuffer(), static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+    if (draw.mesh == nullptr) {
+        binds.BindVertexBuffer(0, draw.vertices.buffer, draw.vertices.offset);
+        binds.BindIndexBuffer(draw.indices.buffer, draw.indices.offset, VK_INDEX_TYPE_UINT32);
+    }
+    else draw.mesh->Bind(binds);
+
+    if (draw.instance_count != 0) binds.BindVertexBuffer(1, draw.instances.buffer, draw.instances.offset);
+
+    // With a count the GPU skips the draws of runs that had every instance culled
+    if (draw.indirect_count.buffer != nullptr)
+        vkCmdDrawIndexedIndirectCount(command_buffer, draw.indirect.buffer, draw.indirect.offset, draw.indirect_count.buffer,
+            draw.indirect_count.offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+    else if (draw.indirect.buffer != nullptr)
+        vkCmdDrawIndexedIndirect(command_buffer, draw.indirect.buffer, draw.indirect.offset, 1, sizeof(VkDrawIndexedIndirectCommand));
+    else vkCmdDrawIndexed(command_buffer, draw.index_count, std::max(draw.instance_count, 1u), 0, 0, 0);
+}
+
+void Context::Impl::RecordDraws3D(std::span<const Draw3D> draws)
+{
+    FlushBatches();
+
+    if (recorder && draws.size() >= 2 * ParallelRecorder::MIN_ITEMS_PER_THREAD) {
+        // The worker threads' command buffers go between the calling thread's, so the draws keep their order
+        EndSecondary();
+
+        const auto recorded = recorder->Record(draws.size(), GetInheritanceInfo(), [&](VkCommandBuffer command_buffer, size_t first, size_t last) {
+            BindCache slice_binds;
+            slice_binds.Begin(command_buffer);
+            SetViewportAndScissor(slice_binds);
+            for (size_t i = first; i < last; ++i) RecordDraw3D(slice_binds, draws[i]);
+
+            std::scoped_lock lock(stats_mutex);
+            parallel_stats += slice_binds.GetStats();
+        });
+
+        secondaries.insert(secondaries.end(), recorded.begin(), recorded.end());
+        BeginSecondary();
+        return;
+    }
+
+    for (const Draw3D& draw : draws) RecordDraw3D(binds, draw);
+}
+
+constexpr uint32_t Context::Impl::SortRank(GraphicsPipelines pipeline) noexcept
+{
+    switch (pipeline) {
+    case GraphicsPipelines::COLOR3D: return 0;
+    case GraphicsPipelines::TEXTURE3D: return 1;
+    case GraphicsPipelines::COLOR3D_INSTANCED: return 0;
+    case GraphicsPipelines::TEXTURE3D_INSTANCED: return 1;
+    case GraphicsPipelines::COLOR2D: return 2;
+    case GraphicsPipelines::TEXTURE2D: return 3;
+    default: return 4;
+    }
+}
+
+bool Context::Impl::CanSortByState(const DeferredDraw& draw) noexcept
+{
+    switch (draw.type) {
+    case DeferredDraw::Type::SPRITE:
+    case DeferredDraw::Type::RECT:
+    case DeferredDraw::Type::TEXT: return false;
+    case DeferredDraw::Type::COLORED_CUBOID: return draw.color.a >= 1.0f;
+    default: return true;
+    }
+}
+
+void Context::Impl::Defer(const DeferredDraw& draw, GraphicsPipelines pipeline, float depth)
+{
+    // A run of sortable draws shares a sequence number, every other draw starts a new one, so only the sortable draws between two
+    // blended ones can change places
+    const bool sortable = CanSortByState(draw);
+    if (!sortable || !sequence_sortable) ++draw_sequence;
+    sequence_sortable = sortable;
+
+    const uint64_t key = sortable ? DrawList::MakeKey(current_layer, draw_sequence, SortRank(pipeline), static_cast<uint32_t>(draw.texture), depth) :
+        DrawList::MakeKey(current_layer, draw_sequence, 0, 0, 0.0f);
+
+    draw_list.Add(key, static_cast<uint32_t>(deferred_draws.size()));
+    deferred_draws.push_back(draw);
+}
+
+uint32_t Context::Impl::DeferCamera(const CameraView& camera)
+{
+    if (deferred_cameras.empty() || memcmp(&deferred_cameras.back(), &camera, sizeof(CameraView)) != 0) deferred_cameras.push_back(camera);
+    return static_cast<uint32_t>(deferred_cameras.size() - 1);
+}
+
+const Frustum& Context::Impl::GetFrustum(const CameraView& camera)
+{
+    if (!frustum_camera || memcmp(&*frustum_camera, &camera, sizeof(CameraView)) != 0) {
+        frustum_camera = camera;
+        frustum = Frustum::FromCamera(camera);
+    }
+
+    return frustum;
+}
+
+void Context::Impl::CullDeferred()
+{
+    deferred_boxes.Clear();
+    deferred_boxed.clear();
+
+    for (uint32_t i = 0; i < deferred_draws.size(); ++i) {
+        const DeferredDraw& draw = deferred_draws[i];
+
+        switch (draw.type) {
+        case DeferredDraw::Type::TEXTURED_CUBOID:
+        case DeferredDraw::Type::COLORED_CUBOID: deferred_boxes.Add(draw.cuboid); break;
+        case DeferredDraw::Type::TEXTURED_MODEL: deferred_boxes.Add(draw.model->GetBoundsMin(), draw.model->GetBoundsMax()); break;
+        default: continue;
+        }
+
+        deferred_boxed.push_back(i);
+    }
+
+    if (deferred_boxed.empty()) return;
+
+    // Cameras are queued in call order, so the boxes of each camera are next to each other and are tested in one batch
+    deferred_box_visible.resize(deferred_boxed.size());
+    for (size_t first = 0; first < deferred_boxed.size();) {
+        const uint32_t camera = deferred_draws[deferred_boxed[first]].camera;
+
+        size_t last = first + 1;
+        while (last < deferred_boxed.size() && deferred_draws[deferred_boxed[last]].camera == camera) ++last;
+
+        Frustum::FromCamera(deferred_cameras[camera]).Intersects(deferred_boxes, first,
+            std::span(deferred_box_visible).subspan(first, last - first));
+        first = last;
+    }
+
+    deferred_visible.assign(deferred_draws.size(), 1);
+    for (size_t i = 0; i < deferred_boxed.size(); ++i) deferred_visible[deferred_boxed[i]] = deferred_box_visible[i];
+
+    draw_list.RemoveIf([this](const DrawList::Entry& entry) { return deferred_visible[entry.command] == 0; });
+}
+
+void Context::Impl::ExecuteDrawList()
+{
+    // Dropping the draws nobody sees first leaves less to sort, and nothing is written for them
+    CullDeferred();
+    draw_list.Sort();
+
+    const auto& entries = draw_list.GetEntries();
+    for (size_t i = 0; i < entries.size();) {
+        const DeferredDraw& draw = deferred_draws[entries[i].command];
+
+        switch (draw.type) {
+        case DeferredDraw::Type::SPRITE: RecordSprite(draw.texture, draw.src, draw.rect); break;
+        case DeferredDraw::Type::RECT: RecordRect(draw.color, draw.rect); break;
+        case DeferredDraw::Type::TEXT: {
+            const DeferredText& t = deferred_texts[draw.text];
+            if (t.absolute) RecordTextAbs(t.text, draw.texture, draw.color, t.x, t.y, t.size, t.row_width, t.halign, t.valign);
+            else RecordTextRel(t.text, draw.texture, draw.color, t.x, t.y, t.size, t.row_width, t.halign, t.valign);
+            break;
+        }
+        default: {
+            // Sorting puts each run of opaque 3D draws together, grouped by pipeline and texture, so the whole run is prepared first
+            // and then recorded with the binds the draws share elided. 2D draws are merged by the sprite and rectangle batches instead.
+            prepared_draws.clear();
+            for (; i < entries.size(); ++i) {
+                const DeferredDraw& d = deferred_draws[entries[i].command];
+                if (d.type == DeferredDraw::Type::SPRITE || d.type == DeferredDraw::Type::RECT || d.type == DeferredDraw::Type::TEXT) break;
+                prepared_draws.push_back(PrepareDeferred(d));
+            }
+
+            RecordDraws3D(prepared_draws);
+            continue;
+        }
+        }
+
+        ++i;
+    }
+
+    draw_list.Clear();
+    draw_sequence = 0;
+    sequence_sortable = false;
+    deferred_draws.clear();
+    deferred_cameras.clear();
+    deferred_texts.clear();
+}
+
+void Context::Impl::RenderObjects(const CameraView& camera)
+{
+    // Retained objects are recorded right away even with deferred rendering, so they ignore layers and always end up under the draw list
+    FlushBatches();
+    scene.Flush();
+    scene.FlushText([this](const RetainedScene::TextBlock& t) -> const std::vector<float>& {
+        return alphabets[t.font_style].LayoutTextRel(t.text, t.size, t.x, DEFAULT_SCREEN_HEIGHT - t.y - GetTextSizeOffset(t.size, t.valign),
+            swapchain.GetExtent(), t.halign, t.valign, t.row_width);
+    });
+
+    // What a run of objects draws. The bounds are those of the mesh before the objects' transforms.
+    struct RunMesh {
+        size_t texture;
+        const MeshBuffer* mesh;
+        glm::vec3 bounds_min, bounds_max;
+    };
+
+    std::vector<IndirectCuller::Run> runs;
+    std::vector<RunMesh> run_meshes;
+
+    // Every pool is drawn in runs of objects that share a texture (and model), straight from its buffer. With GPU culling the runs are
+    // drawn indirectly instead, from the visible objects the culling shader copied out of the buffer.
+    auto draw_instances = [&](const auto& pool, GraphicsPipelines pipeline, auto&& get_mesh) {
+        if (pool.Empty()) return;
+
+        if (!gpu_culling) {
+            pool.ForEachRun([&](const auto& group, uint32_t first, uint32_t count) {
+                const RingBuffer::Range instances = { pool.GetBuffer(), first * sizeof(Instance3D), nullptr };
+                const RunMesh mesh = get_mesh(group);
+                const Draw3D draw = PrepareInstanced(pipeline, mesh.texture, *mesh.mesh, instances, count, camera);
+                RecordDraws3D({ &draw, 1 });
+            });
+            return;
+        }
+
+        runs.clear();
+        run_meshes.clear();
+        pool.ForEachRun([&](const auto& group, uint32_t first, uint32_t count) {
+            const RunMesh mesh = get_mesh(group);
+            runs.push_back(IndirectCuller::Run{ glm::vec4(mesh.bounds_min, 0.0f), glm::vec4(mesh.bounds_max, 0.0f), first, count,
+                mesh.mesh->GetIndexCount(), 0 });
+            run_meshes.push_back(mesh);
+        });
+
+        const auto job = culler.Cull(BeginCulling(), geometry_buffers[current_frame], pool.GetBuffer(), pool.Size(), runs,
+            Frustum::FromCamera(camera));
+
+        prepared_draws.clear();
+        for (size_t i = 0; i < runs.size(); ++i) {
+            const RingBuffer::Range instances = { job.visible.buffer, job.visible.offset + runs[i].first * sizeof(Instance3D), nullptr };
+            Draw3D draw = PrepareInstanced(pipeline, run_meshes[i].texture, *run_meshes[i].mesh, instances, runs[i].count, camera);
+            draw.indirect = { job.commands.buffer, job.commands.offset + i * sizeof(VkDrawIndexedIndirectCommand), nullptr };
+            if (device.SupportsDrawIndirectCount())
+                draw.indirect_count = { job.counts.buffer, job.counts.offset + i * sizeof(uint32_t), nullptr };
+            prepared_draws.push_back(draw);
+        }
+
+        RecordDraws3D(prepared_draws);
+    };
+
+    draw_instances(scene.GetColoredCuboids(), GraphicsPipelines::COLOR3D_INSTANCED,
+        [this](size_t) { return RunMesh{ 0, &cube_mesh, glm::vec3(0.0f), glm::vec3(1.0f) }; });
+    draw_instances(scene.GetTexturedCuboids(), GraphicsPipelines::TEXTURE3D_INSTANCED,
+        [this](size_t texture) { return RunMesh{ texture, &cube_mesh, glm::vec3(0.0f), glm::vec3(1.0f) }; });
+    draw_instances(scene.GetModelInstances(), GraphicsPipelines::TEXTURE3D_INSTANCED, [this](const RetainedScene::ModelGroup& group) {
+        return RunMesh{ group.texture, &group.model->GetMeshBuffer(device), group.model->GetBoundsMin(), group.model->GetBoundsMax() };
+    });
+
+    // The instanced draws may have moved recording to a new command buffer, which binds follows
+    if (const auto& quads = scene.GetColoredQuads(); !quads.Empty()) {
+        binds.BindPipeline(graphics_pipelines[static_cast<size_t>(GraphicsPipelines::COLOR2D)].GetPipeline());
+
+        quads.ForEachRun([&](size_t, uint32_t first, uint32_t count) {
+            rect_batch.Draw(binds, quads.GetBuffer(), first * sizeof(RectBatch::Instance), count);
+        });
+    }
+
+    if (const auto& quads = scene.GetTexturedQuads(); !quads.Empty() && UsesBindlessTextures()) {
+        // Every quad's vertices hold its texture index, so all of them are drawn at once
+        const auto& pipeline = graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXTURE2D_BINDLESS)];
+
+        binds.BindPipeline(pipeline.GetPipeline());
+        binds.BindDescriptorSet(pipeline.GetLayout(), 0, bindless_textures.GetSet());
+        binds.BindVertexBuffer(0, quads.GetBuffer(), 0);
+        sprite_batch.BindIndices(binds);
+        SpriteBatch::DrawQuads(binds.Get(), 0, quads.Size());
+    }
+    else if (!quads.Empty()) {
+        const auto& pipeline = graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXTURE2D)];
+
+        binds.BindPipeline(pipeline.GetPipeline());
+        binds.BindVertexBuffer(0, quads.GetBuffer(), 0);
+        sprite_batch.BindIndices(binds);
+
+        quads.ForEachRun([&](size_t texture, uint32_t first, uint32_t count) {
+            binds.BindDescriptorSet(pipeline.GetLayout(), 0, texture_sets_2d[texture * MAX_FRAMES_IN_FLIGHT + current_frame]);
+            SpriteBatch::DrawQuads(binds.Get(), first, count);
+        });
+    }
+
+    // Text blocks are drawn from the vertices they were laid out into
+    const auto& text_pipeline = graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXT)];
+    for (const auto& t : scene.GetTextBlocks()) {
+        if (!t.alive || !t.visible || t.vertices.empty()) continue;
+        alphabets[t.font_style].DrawText(binds, sprite_batch, text_pipeline, current_frame, t.vertices.GetBuffer(), 0,
+            Alphabet::GetQuadCount(t.vertices.size()), t.color);
+    }
+}
+
+void Context::Impl::FlushBatches()
+{
+    FlushSprites();
+    FlushRects();
+}
+
+void Context::Impl::FlushSprites()
+{
+    if (UsesBindlessTextures()) {
+        const auto& pipeline = graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXTURE2D_BINDLESS)];
+        sprite_batch.FlushBindless(binds, geometry_buffers[current_frame], pipeline.GetPipeline(), pipeline.GetLayout(),
+            bindless_textures.GetSet());
+        return;
+    }
+
+    const auto& pipeline = graphics_pipelines[static_cast<size_t>(GraphicsPipelines::TEXTURE2D)];
+
+    sprite_batch.Flush(binds, geometry_buffers[current_frame], pipeline.GetPipeline(), pipeline.GetLayout(),
+        [this](size_t texture) { return texture_sets_2d[texture * MAX_FRAMES_IN_FLIGHT + current_frame]; });
+}
+
+void Context::Impl::FlushRects()
+{
+    rect_batch.Flush(binds, geometry_buffers[current_frame], graphics_pipelines[static_cast<size_t>
+        (GraphicsPipelines::COLOR2D)].GetPipeline());
 }
 
 void Context::Impl::RenderTextRel(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
     HorizontalAlignment halign, VerticalAlignment valign)
 {
-    std::span<const Buffer> projection_uniforms = { &uniform_buffers[static_cast<size_t>(UniformBuffers::TEXT_PROJECTION) * MAX_FRAMES_IN_FLIGHT], MAX_FRAMES_IN_FLIGHT };
-
-    float size_offset = size;
-    switch (valign) {
-    case VerticalAlignment::TOP: break;
-    case VerticalAlignment::CENTER: size_offset = 0.0f; break;
-    case VerticalAlignment::BOTTOM: size_offset *= -1.0f; break;
+    if (!deferred_rendering) {
+        RecordTextRel(text, font_style, color, x, y, size, row_width, halign, valign);
+        return;
     }
 
-    alphabets[font_style].RenderTextRel(physical_device, device, command_pool, command_buffers[current_frame], graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::TEXT)], descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::TEXT)], sampler, projection_uniforms, current_frame,
-        text, color, size, x, DEFAULT_SCREEN_HEIGHT - y - size_offset, swapchain.GetExtent(), halign, valign, row_width);
+    deferred_texts.push_back(DeferredText{ std::string(text), x, y, size, row_width, halign, valign, false });
+    Defer(DeferredDraw{ .type = DeferredDraw::Type::TEXT, .texture = font_style, .color = color, .text = static_cast<uint32_t>(deferred_texts.size() - 1) },
+        GraphicsPipelines::TEXT, 0.0f);
 }
 
-void Context::Impl::RenderTextAbs(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
+void Context::Impl::RecordTextRel(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
     HorizontalAlignment halign, VerticalAlignment valign)
 {
-    std::span<const Buffer> projection_uniforms = { &uniform_buffers[static_cast<size_t>(UniformBuffers::TEXT_PROJECTION) * MAX_FRAMES_IN_FLIGHT], MAX_FRAMES_IN_FLIGHT };
+    FlushBatches();
 
-    float size_offset = size;
-    switch (valign) {
-    case VerticalAlignment::TOP: break;
-    case VerticalAlignment::CENTER: size_offset = 0.0f; break;
-    case VerticalAlignment::BOTTOM: size_offset *= -1.0f; break;
+    alphabets[font_style].RenderTextRel(binds, geometry_buffers[current_frame], sprite_batch, graphics_pipelines[static_cast<size_t>
+        (GraphicsPipelines::TEXT)], current_frame,
+        text, color, size, x, DEFAULT_SCREEN_HEIGHT - y - GetTextSizeOffset(size, valign), swapchain.GetExtent(), halign, valign, row_width);
+}
+
+void Context::Impl::RenderTextAbs(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
+    HorizontalAlignment halign, VerticalAlignment valign)
+{
+    if (!deferred_rendering) {
+        RecordTextAbs(text, font_style, color, x, y, size, row_width, halign, valign);
+        return;
     }
 
-    alphabets[font_style].RenderTextAbs(physical_device, device, command_pool, command_buffers[current_frame], graphics_pipelines[static_cast<size_t>
-        (GraphicsPipelines::TEXT)], descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::TEXT)], sampler, projection_uniforms, current_frame,
-        text, color, size, x, static_cast<float>(swapchain.GetHeight()) - y - size_offset, halign, valign, row_width);
+    deferred_texts.push_back(DeferredText{ std::string(text), x, y, size, row_width, halign, valign, true });
+    Defer(DeferredDraw{ .type = DeferredDraw::Type::TEXT, .texture = font_style, .color = color, .text = static_cast<uint32_t>(deferred_texts.size() - 1) },
+        GraphicsPipelines::TEXT, 0.0f);
+}
+
+void Context::Impl::RecordTextAbs(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
+    HorizontalAlignment halign, VerticalAlignment valign)
+{
+    FlushBatches();
+
+    alphabets[font_style].RenderTextAbs(binds, geometry_buffers[current_frame], sprite_batch, graphics_pipelines[static_cast<size_t>
+        (GraphicsPipelines::TEXT)], current_frame,
+        text, color, size, x, static_cast<float>(swapchain.GetHeight()) - y - GetTextSizeOffset(size, valign), halign, valign, row_width);
 }
 
 void Context::Impl::LoadTexture(std::string_view path)
 {
+    if (UsesBindlessTextures() && textures.size() >= bindless_textures.GetCapacity())
+        throw std::runtime_error("Too many textures. The bindless texture array is full.");
+
     if (path.empty()) {
         textures.emplace_back();
+        RegisterTexture();
         return;
     }
 
@@ -868,25 +1638,65 @@ void Context::Impl::LoadTexture(std::string_view path)
         VK_SAMPLE_COUNT_1_BIT, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
         VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0, path, true);
 
-    AddDescriptorSet2D(textures.back());
-    AddDescriptorSet3D(textures.back());
-
-    /*for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
-        vertex_buffers[i].resize(vertex_buffers.size() + 1);
-        index_buffers[i].resize(index_buffers.size() + 1);
-    }*/
+    RegisterTexture();
 }
 
 void Context::Impl::LoadTextures(std::span<const std::string_view> paths)
 {
-    textures.resize(textures.size() + paths.size());
+    textures.reserve(textures.size() + paths.size());
 
     for (const auto p : paths) LoadTexture(p);
 }
 
+std::vector<AtlasRegion> Context::Impl::LoadAtlas(std::span<const std::string_view> paths, uint32_t page_size)
+{
+    const AtlasPages atlas = AtlasPages::Pack(paths, page_size);
+
+    if (UsesBindlessTextures() && textures.size() + atlas.pages.size() > bindless_textures.GetCapacity())
+        throw std::runtime_error("Too many textures. The bindless texture array is full.");
+
+    // The pages go after the existing textures, and every image of a page is drawn with the page's descriptor set
+    size_t first_page = 0;
+    for (size_t i = 0; i < atlas.pages.size(); ++i) {
+        textures.emplace_back(physical_device, device, command_pool, VK_FORMAT_R8G8B8A8_SRGB, atlas.size, atlas.size, atlas.pages[i],
+            VK_IMAGE_TILING_OPTIMAL, VK_SAMPLE_COUNT_1_BIT, AtlasPages::MIP_LEVELS);
+        const size_t index = RegisterTexture();
+        if (i == 0) first_page = index;
+    }
+
+    std::vector<AtlasRegion> regions;
+    regions.reserve(atlas.regions.size());
+    for (const auto& [page, src] : atlas.regions) regions.push_back(AtlasRegion{ first_page + page, src });
+
+    return regions;
+}
+
+size_t Context::Impl::RegisterTexture()
+{
+    const size_t index = textures.size() - 1;
+
+    // An empty texture has nothing to bind. Its slot of the texture array stays unwritten, and its descriptor sets are null.
+    if (!textures.back().GetView()) {
+        if (!UsesBindlessTextures()) {
+            texture_sets_2d.resize(texture_sets_2d.size() + MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+            texture_sets_3d.resize(texture_sets_3d.size() + MAX_FRAMES_IN_FLIGHT, VK_NULL_HANDLE);
+        }
+        return index;
+    }
+
+    // The slot of a new texture isn't used by any frame in flight, so it can be written while they are
+    if (UsesBindlessTextures()) {
+        bindless_textures.Set(static_cast<uint32_t>(index), textures.back().GetView(), sampler.Get());
+        return index;
+    }
+
+    AddDescriptorSet2D(textures.back());
+    AddDescriptorSet3D(textures.back());
+    return index;
+}
+
 void Context::Impl::LoadAlphabet(std::string_view path)
 {
-    // std::span<const Buffer> color_uniforms = { &uniform_buffers[static_cast<size_t>(UniformBuffers::TEXT_COLOR) * MAX_FRAMES_IN_FLIGHT], MAX_FRAMES_IN_FLIGHT };
     std::span<const Buffer> projection_uniforms = { &uniform_buffers[static_cast<size_t>(UniformBuffers::TEXT_PROJECTION) * MAX_FRAMES_IN_FLIGHT], MAX_FRAMES_IN_FLIGHT };
 
     alphabets.emplace_back(freetype, path, physical_device, device, command_pool, descriptor_set_layouts[static_cast<size_t>(GraphicsPipelines::TEXT)],
@@ -966,9 +1776,9 @@ void Context::Impl::AddDescriptorSet3D(const Texture& texture)
     for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
         const VkDescriptorImageInfo face_info = { sampler.Get(), texture.GetView(), VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
         const VkDescriptorBufferInfo buffer_info = {
-            .buffer = uniform_buffers[static_cast<size_t>(UniformBuffers::TEXTURE3D) * MAX_FRAMES_IN_FLIGHT + i].GetBuffer(),
+            .buffer = camera_uniforms[i].GetBuffer().GetBuffer(),
             .offset = 0,
-            .range = sizeof(CameraView)
+            .range = camera_uniforms[i].GetElementSize()
         };
 
         const std::array<VkWriteDescriptorSet, 2> sets = {{
@@ -978,7 +1788,7 @@ void Context::Impl::AddDescriptorSet3D(const Texture& texture)
                 .dstBinding = 0,
                 .dstArrayElement = 0,
                 .descriptorCount = 1,
-                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+                .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
                 .pBufferInfo = &buffer_info
             },
             {
@@ -1043,6 +1853,11 @@ void Context::Render2D(size_t texture, Rect src, Rect dst) const
     impl->Render2D(texture, src, dst);
 }
 
+void Context::Render2D(const AtlasRegion& region, Rect dst) const
+{
+    impl->Render2D(region.texture, region.src, dst);
+}
+
 void Context::Color2D(Color color, Rect area) const
 {
     impl->Color2D(color, area);
@@ -1063,6 +1878,21 @@ void Context::Color3D(Color color, Cuboid area, const CameraView& camera) const
     impl->Color3D(color, area, camera);
 }
 
+void Context::Color3DInstanced(std::span<const Instance3D> instances, const CameraView& camera) const
+{
+    impl->Color3DInstanced(instances, camera);
+}
+
+void Context::Render3DInstanced(size_t texture, std::span<const Instance3D> instances, const CameraView& camera) const
+{
+    impl->Render3DInstanced(texture, instances, camera);
+}
+
+void Context::Render3DInstanced(size_t texture, const Model& model, std::span<const Instance3D> instances, const CameraView& camera) const
+{
+    impl->Render3DInstanced(texture, model, instances, camera);
+}
+
 void Context::RenderTextRel(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
     HorizontalAlignment halign, VerticalAlignment valign) const
 {
@@ -1085,6 +1915,11 @@ void Context::LoadTextures(std::span<const std::string_view> paths) const
     impl->LoadTextures(paths);
 }
 
+std::vector<AtlasRegion> Context::LoadAtlas(std::span<const std::string_view> paths, uint32_t page_size) const
+{
+    return impl->LoadAtlas(paths, page_size);
+}
+
 void Context::LoadAlphabet(std::string_view path) const
 {
     impl->LoadAlphabet(path);
@@ -1119,11 +1954,127 @@ int Context::GetWindowHeight() const noexcept
     return impl->GetSwapchainExtent().height;
 }
 
+MemoryReport Context::GetMemoryReport() const
+{
+    return impl->GetMemoryReport();
+}
+
+RecordingStats Context::GetRecordingStats() const noexcept
+{
+    return impl->GetRecordingStats();
+}
+
+bool Context::UsesBindlessTextures() const noexcept
+{
+    return impl->UsesBindlessTextures();
+}
+
 void Context::SetFramebufferResized() const noexcept
 {
     impl->SetFramebufferResized();
 }
 
+void Context::SetDeferredRendering(bool deferred) const noexcept
+{
+    impl->SetDeferredRendering(deferred);
+}
+
+void Context::SetLayer(uint8_t layer) const noexcept
+{
+    impl->SetLayer(layer);
+}
+
+void Context::SetRecordingThreads(uint32_t count) const
+{
+    impl->SetRecordingThreads(count);
+}
+
+void Context::SetGPUCulling(bool enabled) const
+{
+    impl->SetGPUCulling(enabled);
+}
+
+ObjectHandle Context::CreateQuad(Color color, Rect area) const
+{
+    return impl->GetScene().CreateQuad(color, area);
+}
+
+ObjectHandle Context::CreateQuad(size_t texture, Rect dst) const
+{
+    return impl->GetScene().CreateQuad(texture, dst);
+}
+
+ObjectHandle Context::CreateCuboid(Color color, Cuboid area) const
+{
+    return impl->GetScene().CreateCuboid(color, area);
+}
+
+ObjectHandle Context::CreateCuboid(size_t texture, Cuboid area) const
+{
+    return impl->GetScene().CreateCuboid(texture, area);
+}
+
+ObjectHandle Context::CreateModelInstance(size_t texture, const Model& model, const glm::mat4& transform) const
+{
+    return impl->GetScene().CreateModelInstance(texture, model, transform);
+}
+
+ObjectHandle Context::CreateTextBlock(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
+    HorizontalAlignment halign, VerticalAlignment valign) const
+{
+    return impl->GetScene().CreateTextBlock(text, font_style, color, x, y, size, row_width, halign, valign);
+}
+
+void Context::SetObjectArea(ObjectHandle object, Rect area) const
+{
+    impl->GetScene().SetArea(object, area);
+}
+
+void Context::SetObjectArea(ObjectHandle object, Cuboid area) const
+{
+    impl->GetScene().SetArea(object, area);
+}
+
+void Context::SetObjectTransform(ObjectHandle object, const glm::mat4& transform) const
+{
+    impl->GetScene().SetTransform(object, transform);
+}
+
+void Context::SetObjectColor(ObjectHandle object, Color color) const
+{
+    impl->GetScene().SetColor(object, color);
+}
+
+void Context::SetObjectText(ObjectHandle object, std::string_view text) const
+{
+    impl->GetScene().SetText(object, text);
+}
+
+void Context::SetObjectFont(ObjectHandle object, size_t font_style, float size) const
+{
+    impl->GetScene().SetFont(object, font_style, size);
+}
+
+void Context::SetObjectPosition(ObjectHandle object, float x, float y) const
+{
+    impl->GetScene().SetPosition(object, x, y);
+}
+
+void Context::SetObjectVisible(ObjectHandle object, bool visible) const
+{
+    impl->GetScene().SetVisible(object, visible);
+}
+
+void Context::DestroyObject(ObjectHandle object) const
+{
+    impl->GetScene().Destroy(object);
+}
+
+void Context::RenderObjects(const CameraView& camera) const
+{
+    impl->RenderObjects(camera);
+}
+
 void Context::SetParentWindow(void* native_handle)
 {
     impl->SetParentWindow(native_handle);
@@ -3,10 +3,14 @@
 
 #include <string_view>
 #include <span>
+#include <vector>
 #include <limits>
 #include <memory>
+#include <cstdint>
 
 #include "RenderData.h"
+#include "MemoryReport.h"
+#include "RecordingStats.h"
 
 namespace VKKit {
 class Model;
@@ -17,6 +21,15 @@ enum class HorizontalAlignment { LEFT, CENTER, RIGHT };
 // How to vertically align text that is rendered on the screen
 enum class VerticalAlignment { TOP, CENTER, BOTTOM };
 
+// The kind of a retained object
+enum class ObjectType : uint8_t { COLORED_QUAD, TEXTURED_QUAD, COLORED_CUBOID, TEXTURED_CUBOID, MODEL_INSTANCE, TEXT_BLOCK };
+
+// A retained object created by the context. The handle stays valid until the object is destroyed.
+struct ObjectHandle {
+    ObjectType type;
+    uint32_t index;
+};
+
 // A Vulkan rendering context that renders using the Vulkan API
 class Context {
 public:
@@ -75,11 +88,18 @@ public:
     /**
      * @brief Render part of a 2D image on the screen
      * @param texture The index of the texture. This is the index at which the image is stored in the context's internal array.
-     * @param src The part of the texture to render (in normalized Vulkan coordinates).
+     * @param src The part of the texture to render (in texture coordinates, from (0, 0) at the top left to (1, 1) at the bottom right).
      * @param dst The destination on the screen on which to render (in normalized Vulkan coordiantes).
      */
     void Render2D(size_t texture, Rect src, Rect dst) const;
 
+    /**
+     * @brief Render an image of a texture atlas on the screen. Images on the same page are batched like images of the same texture.
+     * @param region The image, as returned by LoadAtlas
+     * @param dst The destination on the screen on which to render (in normalized Vulkan coordinates).
+     */
+    void Render2D(const AtlasRegion& region, Rect dst) const;
+
     /**
      * @brief Render a rectangle on the screen
      * @param color The color of the rectangle
@@ -88,7 +108,7 @@ public:
     void Color2D(Color color, Rect area) const;
 
     /**
-     * @brief Render a textured cuboid on the screen
+     * @brief Render a textured cuboid on the screen. Cuboids outside the camera's view are skipped.
      * @param texture The index of the texture (this is the index at which the texture is found in the context's internal array).
      * @param area The destination on the screen on which to render (in normalized Vulkan coordinates)
      * @param camera The camera view which will be looking at the scene
@@ -96,7 +116,7 @@ public:
     void Render3D(size_t texture, Cuboid area, const CameraView& camera) const;
 
     /**
-     * @brief Render a textured model on the screen
+     * @brief Render a textured model on the screen. Models whose bounds are outside the camera's view are skipped.
      * @param texture The index of the texture (this is the index at which the texture is found in the context's internal array).
      * @param model The model to be used for the rendering
      * @param camera The camera view which will be looking at the scene
@@ -104,13 +124,39 @@ public:
     void Render3D(size_t texture, const Model& model, const CameraView& camera) const;
 
     /**
-     * @brief Render a colored cuboid on the screen
+     * @brief Render a colored cuboid on the screen. Cuboids outside the camera's view are skipped.
      * @param color The color of the cuboid
      * @param area The destination on which to render (in normalized Vulkan coordinates)
      * @param camera The camera view which will look at the scene
      */
     void Color3D(Color color, Cuboid area, const CameraView& camera) const;
 
+    /**
+     * @brief Render many colored cuboids with one draw call. Each instance stretches the unit cube (0, 0, 0) - (1, 1, 1) with its transform
+     *        (see Instance3D::FromCuboid) and colours it with its color.
+     * @param instances The transforms and colors of the cuboids
+     * @param camera The camera view which will look at the scene
+     */
+    void Color3DInstanced(std::span<const Instance3D> instances, const CameraView& camera) const;
+
+    /**
+     * @brief Render many textured cuboids with one draw call. Each instance stretches the unit cube (0, 0, 0) - (1, 1, 1) with its transform
+     *        (see Instance3D::FromCuboid). The texture is multiplied by the instance's color.
+     * @param texture The index of the texture (this is the index at which the texture is found in the context's internal array).
+     * @param instances The transforms and tints of the cuboids
+     * @param camera The camera view which will look at the scene
+     */
+    void Render3DInstanced(size_t texture, std::span<const Instance3D> instances, const CameraView& camera) const;
+
+    /**
+     * @brief Render many copies of a textured model with one draw call. The model's geometry stays resident on the GPU.
+     * @param texture The index of the texture (this is the index at which the texture is found in the context's internal array).
+     * @param model The model to be used for the rendering
+     * @param instances The transforms and tints of the copies. The texture is multiplied by the instance's color.
+     * @param camera The camera view which will look at the scene
+     */
+    void Render3DInstanced(size_t texture, const Model& model, std::span<const Instance3D> instances, const CameraView& camera) const;
+
     /**
      * @brief Render text on the screen with relative sizing. Text will appear full size on a 1920x1080 display, and will be
      *        scaled up/down if the display is different.
@@ -142,9 +188,96 @@ public:
     void RenderTextAbs(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width = std::numeric_limits<float>::max(),
         HorizontalAlignment halign = HorizontalAlignment::LEFT, VerticalAlignment valign = VerticalAlignment::TOP) const;
 
+    /**
+     * @brief Create a retained rectangle of a single color. Retained objects keep their geometry on the GPU between frames, so drawing
+     *        them costs no per-frame uploads. Only objects that change are uploaded again. They are drawn by RenderObjects.
+     * @param color The color of the rectangle
+     * @param area The area of the rectangle (in normalized Vulkan coordinates)
+     * @return The handle of the object
+     */
+    ObjectHandle CreateQuad(Color color, Rect area) const;
+
+    /**
+     * @brief Create a retained textured rectangle
+     * @param texture The index of the texture
+     * @param dst Where to draw the texture (in normalized Vulkan coordinates)
+     * @return The handle of the object
+     */
+    ObjectHandle CreateQuad(size_t texture, Rect dst) const;
+
+    /**
+     * @brief Create a retained cuboid of a single color
+     * @param color The color of the cuboid
+     * @param area The area of the cuboid
+     * @return The handle of the object
+     */
+    ObjectHandle CreateCuboid(Color color, Cuboid area) const;
+
+    /**
+     * @brief Create a retained textured cuboid
+     * @param texture The index of the texture
+     * @param area The area of the cuboid
+     * @return The handle of the object
+     */
+    ObjectHandle CreateCuboid(size_t texture, Cuboid area) const;
+
+    /**
+     * @brief Create a retained instance of a model. The model must outlive the object.
+     * @param texture The index of the texture
+     * @param model The model
+     * @param transform Applied to the model before the camera's model matrix
+     * @return The handle of the object
+     */
+    ObjectHandle CreateModelInstance(size_t texture, const Model& model, const glm::mat4& transform) const;
+
+    /**
+     * @brief Create a retained block of text, drawn with relative sizing like RenderTextRel. The parameters are the same as RenderTextRel's.
+     * @return The handle of the object
+     */
+    ObjectHandle CreateTextBlock(std::string_view text, size_t font_style, Color color, float x, float y, float size,
+        float row_width = std::numeric_limits<float>::max(), HorizontalAlignment halign = HorizontalAlignment::LEFT,
+        VerticalAlignment valign = VerticalAlignment::TOP) const;
+
+    // Move or resize a retained quad. Throws std::runtime_error if object isn't a quad.
+    void SetObjectArea(ObjectHandle object, Rect area) const;
+
+    // Move or resize a retained cuboid. Throws std::runtime_error if object isn't a cuboid.
+    void SetObjectArea(ObjectHandle object, Cuboid area) const;
+
+    // Set the transform of a retained model instance or cuboid. Throws std::runtime_error if object is neither.
+    void SetObjectTransform(ObjectHandle object, const glm::mat4& transform) const;
+
+    // Set the color of a retained object, or the tint of a textured cuboid or model instance. Throws std::runtime_error if object is a
+    // textured quad.
+    void SetObjectColor(ObjectHandle object, Color color) const;
+
+    // Set the text of a retained text block. Throws std::runtime_error if object isn't a text block.
+    void SetObjectText(ObjectHandle object, std::string_view text) const;
+
+    // Set the font style and size of a retained text block. Throws std::runtime_error if object isn't a text block.
+    void SetObjectFont(ObjectHandle object, size_t font_style, float size) const;
+
+    // Move a retained text block. Throws std::runtime_error if object isn't a text block.
+    void SetObjectPosition(ObjectHandle object, float x, float y) const;
+
+    // Show or hide a retained object. Hidden objects keep their properties and can still be changed.
+    void SetObjectVisible(ObjectHandle object, bool visible) const;
+
+    // Destroy a retained object. Its handle must not be used again.
+    void DestroyObject(ObjectHandle object) const;
+
+    /**
+     * @brief Draw every visible retained object: cuboids and model instances first, then quads, then text blocks. The objects are
+     *        recorded when this is called, so call it before the draws that go on top of them. When deferred rendering is on, they are
+     *        still recorded immediately, so they are drawn under every queued draw whatever its layer.
+     * @param camera The camera the cuboids and model instances are seen through
+     */
+    void RenderObjects(const CameraView& camera) const;
+
     /** 
      * @brief Load a texture from path and append to the array of textures.
-     * @param path The path to the file of the texture. If empty, appends an empty texture to the array.
+     * @param path The path to the file of the texture. If empty, appends an empty texture to the array, which takes up an index but
+     *        must not be drawn.
      * @exception std::runtime_error with error information on failure
      */
     void LoadTexture(std::string_view path) const;
@@ -156,6 +289,17 @@ public:
      */
     void LoadTextures(std::span<const std::string_view> paths) const;
 
+    /**
+     * @brief Load many small images (icons, sprites) and pack them into a few large textures, the pages of an atlas. The pages are appended
+     *        to the array of textures. Every image is padded with copies of its edge texels so neighbours don't bleed into it when it is
+     *        filtered, and the pages only get as many mip levels as the padding covers.
+     * @param paths The file paths of the images
+     * @param page_size The width and height of the pages in texels. Every image has to fit on one page.
+     * @return Where each image is, in the order of paths. Draw them with Render2D(const AtlasRegion&, Rect).
+     * @exception std::runtime_error with error information if loading an image or creating a page fails
+     */
+    std::vector<AtlasRegion> LoadAtlas(std::span<const std::string_view> paths, uint32_t page_size = 2048) const;
+
     /**
      * @brief Loads a font for rendering and appends it to the loaded fonts.
      * @param path The path to the font's file
@@ -185,9 +329,61 @@ public:
     // Returns the heightof the window of the context.
     int GetWindowHeight() const noexcept;
 
+    /**
+     * @brief Get how much device memory the context is using, broken down by category (geometry, textures, fonts, ...) and by heap.
+     *        Both current and peak usage are reported. Heap budgets are queried from the driver when VK_EXT_memory_budget is supported.
+     */
+    MemoryReport GetMemoryReport() const;
+
+    /**
+     * @brief Get how many binds the last ended frame recorded, and how many it skipped because the command buffer already had the same
+     *        pipeline, descriptor set, buffer, viewport or scissor bound
+     */
+    RecordingStats GetRecordingStats() const noexcept;
+
+    /**
+     * @brief Whether textures are bindless. When the device supports descriptor indexing, every texture is kept in one texture array, so
+     *        draws with different textures don't rebind descriptor sets and sprites with different textures are drawn with one draw
+     *        call. The number of textures is then only limited by the device. Otherwise every texture has its own descriptor sets.
+     */
+    bool UsesBindlessTextures() const noexcept;
+
     // Notifies the context that the framebuffer has been resized. Call this function when resizing the window.
     void SetFramebufferResized() const noexcept;
 
+    /**
+     * @brief Turn deferred rendering on or off. Only change it between frames.
+     *        While it is on, draw calls are queued instead of recorded. EndRendering records them by layer, and within a layer in call
+     *        order. Only consecutive opaque 3D draws (every 3D draw except colored cuboids with alpha below 1) are reordered among
+     *        themselves, by pipeline, texture and depth, so they are recorded with as few binds as possible. 2D draws and text keep their
+     *        stacking. Retained objects are not queued: RenderObjects always records them immediately, under every queued draw.
+     * @param deferred true to queue the draw calls, false to record them immediately (the default)
+     */
+    void SetDeferredRendering(bool deferred) const noexcept;
+
+    // Set the layer of the following draw calls when deferred rendering is on. Layers are drawn in increasing order, starting at 0.
+    void SetLayer(uint8_t layer) const noexcept;
+
+    /**
+     * @brief Set how many worker threads record the draws queued with deferred rendering. Long runs of queued 3D draws are split between
+     *        the threads, and each thread records its part into its own secondary command buffer. Everything else is still recorded on
+     *        the calling thread. Only change it between frames, it waits for the device to be idle.
+     * @param count The number of worker threads. 0 or 1 records everything on the calling thread (the default).
+     * @exception std::runtime_error with error information on failure
+     */
+    void SetRecordingThreads(uint32_t count) const;
+
+    /**
+     * @brief Turn culling of the retained 3D objects on the GPU on or off. Only change it between frames.
+     *        While it is on, RenderObjects has a compute shader test the cuboids and model instances against the camera's frustum and
+     *        draws only the visible ones, with indirect draws whose counts the shader wrote. The CPU never reads the objects back, so this
+     *        pays off for scenes with many objects of which a large part is off screen. The culling pipeline is created the first time
+     *        it is turned on. Devices with the drawIndirectCount feature skip the draws of fully culled runs on the GPU.
+     * @param enabled true to cull on the GPU, false to draw every object (the default)
+     * @exception std::runtime_error with error information on failure
+     */
+    void SetGPUCulling(bool enabled) const;
+
     void SetParentWindow(void* native_handle);
 
 private:
@@ -23,12 +23,29 @@ DescriptorSetLayout CreateTexture2DLayout(const Device& device);
 GraphicsPipeline CreateColor3DPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
     const Swapchain& swapchain, const DescriptorSetLayout& dsl, VkSampleCountFlagBits msaa);
 DescriptorSetLayout CreateColor3DLayout(const Device& device);
-VkDescriptorSet CreateColor3DSet(const Device& device, const DescriptorPool& pool, const DescriptorSetLayout& dsl, std::span<const Buffer> uniform_buffers);
+// Create a Color3D set that reads the camera from camera_uniform at a dynamic offset
+VkDescriptorSet CreateColor3DSet(const Device& device, const DescriptorPool& pool, const DescriptorSetLayout& dsl, const Buffer& camera_uniform,
+    VkDeviceSize camera_size);
 
 GraphicsPipeline CreateTexture3DPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
     const Swapchain& swapchain, const DescriptorSetLayout& dsl, VkSampleCountFlagBits msaa);
 DescriptorSetLayout CreateTexture3DLayout(const Device& device);
 
+// The instanced pipelines draw a mesh once per Instance3D. They use the layouts of the Color3D and Texture3D pipelines.
+GraphicsPipeline CreateColor3DInstancedPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
+    const Swapchain& swapchain, const DescriptorSetLayout& dsl, VkSampleCountFlagBits msaa);
+GraphicsPipeline CreateTexture3DInstancedPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
+    const Swapchain& swapchain, const DescriptorSetLayout& dsl, VkSampleCountFlagBits msaa);
+
+// The bindless pipelines read their texture from the array of BindlessTextures, by the index in the sprite vertices (2D) or pushed after
+// the model matrix (3D). The 3D ones use the Color3D layout for the camera as set 0 and the texture array as set 1.
+GraphicsPipeline CreateTexture2DBindlessPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
+    const Swapchain& swapchain, const DescriptorSetLayout& textures_dsl, VkSampleCountFlagBits msaa);
+GraphicsPipeline CreateTexture3DBindlessPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
+    const Swapchain& swapchain, const DescriptorSetLayout& camera_dsl, const DescriptorSetLayout& textures_dsl, VkSampleCountFlagBits msaa);
+GraphicsPipeline CreateTexture3DInstancedBindlessPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
+    const Swapchain& swapchain, const DescriptorSetLayout& camera_dsl, const DescriptorSetLayout& textures_dsl, VkSampleCountFlagBits msaa);
+
 GraphicsPipeline CreateTextPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
     const Swapchain& swapchain, const DescriptorSetLayout& dsl, VkSampleCountFlagBits msaa);
 DescriptorSetLayout CreateTextLayout(const Device& device);
@@ -6,23 +6,38 @@
 #include "../Constants.h"
 
 namespace VKKit {
-static constexpr VkVertexInputBindingDescription COLOR_DESCRIPTION = {
-    .stride = 7 * sizeof(float),
-    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
-};
+// Binding 0 is the unit quad, binding 1 holds one rectangle and colour per instance
+static constexpr std::array<VkVertexInputBindingDescription, 2> COLOR_DESCRIPTIONS = {{
+    {
+        .binding = 0,
+        .stride = 2 * sizeof(float),
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+    },
+    {
+        .binding = 1,
+        .stride = 8 * sizeof(float),
+        .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+    }
+}};
 
-static constexpr std::array<VkVertexInputAttributeDescription, 2> COLOR_ATTRIBUTES = {{
+static constexpr std::array<VkVertexInputAttributeDescription, 3> COLOR_ATTRIBUTES = {{
     {
         .location = 0,
         .binding = 0,
-        .format = VK_FORMAT_R32G32B32_SFLOAT,
+        .format = VK_FORMAT_R32G32_SFLOAT,
         .offset = 0
     },
     {
         .location = 1,
-        .binding = 0,
+        .binding = 1,
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .offset = 0
+    },
+    {
+        .location = 2,
+        .binding = 1,
         .format = VK_FORMAT_R32G32B32A32_SFLOAT,
-        .offset = 3 * sizeof(float)
+        .offset = 4 * sizeof(float)
     }
 }};
 
@@ -31,8 +46,8 @@ GraphicsPipeline CreateColor2DPipeline(VkPhysicalDevice physical_device, const D
 {
     const VkPipelineVertexInputStateCreateInfo vertex_input_info = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
-        .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &COLOR_DESCRIPTION,
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(COLOR_DESCRIPTIONS.size()),
+        .pVertexBindingDescriptions = COLOR_DESCRIPTIONS.data(),
         .vertexAttributeDescriptionCount = static_cast<uint32_t>(COLOR_ATTRIBUTES.size()),
         .pVertexAttributeDescriptions = COLOR_ATTRIBUTES.data()
     };
@@ -127,13 +127,20 @@ GraphicsPipeline CreateColor3DPipeline(VkPhysicalDevice physical_device, const D
         .maxDepthBounds = 1.0f
     };
 
+    // The model matrix of each draw is pushed, the camera is read from the uniform buffer
+    const VkPushConstantRange push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .offset = 0,
+        .size = sizeof(glm::mat4)
+    };
+
     const auto layout = dsl.Get();
     const VkPipelineLayoutCreateInfo pipeline_layout_info = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .setLayoutCount = 1,
         .pSetLayouts = &layout,
-        .pushConstantRangeCount = 0,
-        .pPushConstantRanges = nullptr
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range
     };
 
     return GraphicsPipeline(physical_device, device.Get(), VKKIT_DIRECTORY "/Shaders/Color3Dv.spv", VKKIT_DIRECTORY "/Shaders/Color3Df.spv", vertex_input_info,
@@ -146,7 +153,7 @@ DescriptorSetLayout CreateColor3DLayout(const Device& device)
     static constexpr std::array<VkDescriptorSetLayoutBinding, 1> color3d_bindings = {
         VkDescriptorSetLayoutBinding {
             .binding = 0,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
             .descriptorCount = 1,
             .stageFlags = VK_SHADER_STAGE_VERTEX_BIT
         }
@@ -155,7 +162,8 @@ DescriptorSetLayout CreateColor3DLayout(const Device& device)
     return DescriptorSetLayout(device, color3d_bindings);
 }
 
-VkDescriptorSet CreateColor3DSet(const Device& device, const DescriptorPool& pool, const DescriptorSetLayout& dsl, std::span<const Buffer> uniform_buffers)
+VkDescriptorSet CreateColor3DSet(const Device& device, const DescriptorPool& pool, const DescriptorSetLayout& dsl, const Buffer& camera_uniform,
+    VkDeviceSize camera_size)
 {
     const auto layout = dsl.Get();
 
@@ -171,25 +179,23 @@ VkDescriptorSet CreateColor3DSet(const Device& device, const DescriptorPool& poo
 
     if (alloc_result != VK_SUCCESS) ThrowError("Failed to allocate Color3D set.", alloc_result);
 
-    for (size_t i = 0; i < uniform_buffers.size(); ++i) {
-        const VkDescriptorBufferInfo buffer_info = {
-            .buffer = uniform_buffers[i].GetBuffer(),
-            .offset = 0,
-            .range = sizeof(CameraView)
-        };
-
-        const VkWriteDescriptorSet descriptor_write = {
-            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
-            .dstSet = set,
-            .dstBinding = 0,
-            .dstArrayElement = 0,
-            .descriptorCount = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .pBufferInfo = &buffer_info
-        };
+    const VkDescriptorBufferInfo buffer_info = {
+        .buffer = camera_uniform.GetBuffer(),
+        .offset = 0,
+        .range = camera_size
+    };
 
-        vkUpdateDescriptorSets(device.Get(), 1, &descriptor_write, 0, nullptr);
-    }
+    const VkWriteDescriptorSet descriptor_write = {
+        .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+        .dstSet = set,
+        .dstBinding = 0,
+        .dstArrayElement = 0,
+        .descriptorCount = 1,
+        .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
+        .pBufferInfo = &buffer_info
+    };
+
+    vkUpdateDescriptorSets(device.Get(), 1, &descriptor_write, 0, nullptr);
 
     return set;
 }
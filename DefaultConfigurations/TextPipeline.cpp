@@ -125,13 +125,20 @@ GraphicsPipeline CreateTextPipeline(VkPhysicalDevice physical_device, const Devi
         .maxDepthBounds = 1.0f
     };
 
+    // The color of the text
+    const VkPushConstantRange push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+        .offset = 0,
+        .size = sizeof(Color)
+    };
+
     const auto layout = dsl.Get();
     const VkPipelineLayoutCreateInfo pipeline_layout_info = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .setLayoutCount = 1,
         .pSetLayouts = &layout,
-        .pushConstantRangeCount = 0,
-        .pPushConstantRanges = nullptr
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range
     };
 
     return GraphicsPipeline(physical_device, device.Get(), VKKIT_DIRECTORY "/Shaders/Textv.spv", VKKIT_DIRECTORY "/Shaders/Textf.spv",
@@ -141,19 +148,13 @@ GraphicsPipeline CreateTextPipeline(VkPhysicalDevice physical_device, const Devi
 
 DescriptorSetLayout CreateTextLayout(const Device& device)
 {
-    static constexpr std::array<VkDescriptorSetLayoutBinding, 3> tex_bindings = {
+    static constexpr std::array<VkDescriptorSetLayoutBinding, 2> tex_bindings = {
         VkDescriptorSetLayoutBinding {
             .binding = 0,
             .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER,
             .descriptorCount = 1,
             .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
         },
-        VkDescriptorSetLayoutBinding {
-            .binding = 1,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
-            .descriptorCount = 1,
-            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT
-        },
         VkDescriptorSetLayoutBinding {
             .binding = 2,
             .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
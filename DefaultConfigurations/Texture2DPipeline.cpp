@@ -7,7 +7,7 @@
 
 namespace VKKit {
 static constexpr VkVertexInputBindingDescription TEXTURE_2D_DESCRIPTION = {
-    .stride = 5 * sizeof(float),
+    .stride = 6 * sizeof(float), // The texture index after the texture coordinates is only read by the bindless pipeline
     .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
 };
 
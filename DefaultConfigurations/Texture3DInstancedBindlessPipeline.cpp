@@ -0,0 +1,196 @@
+#include "../DefaultConfigurations.h"
+#include "../Device.h"
+#include "../RenderPass.h"
+#include "../Swapchain.h"
+#include "../DescriptorSetLayout.h"
+#include "../RenderData.h"
+#include "../Constants.h"
+
+namespace VKKit {
+// Binding 0 is the mesh (position, texture coordinates), binding 1 holds one Instance3D per instance
+static constexpr std::array<VkVertexInputBindingDescription, 2> INSTANCED_DESCRIPTIONS = {{
+    {
+        .binding = 0,
+        .stride = 5 * sizeof(float),
+        .inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+    },
+    {
+        .binding = 1,
+        .stride = sizeof(Instance3D),
+        .inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+    }
+}};
+
+// The position and texture coordinates of the mesh, then the transform (one column per location) and tint of the instance
+static constexpr std::array<VkVertexInputAttributeDescription, 7> INSTANCED_ATTRIBUTES = {{
+    {
+        .location = 0,
+        .binding = 0,
+        .format = VK_FORMAT_R32G32B32_SFLOAT,
+        .offset = 0
+    },
+    {
+        .location = 1,
+        .binding = 0,
+        .format = VK_FORMAT_R32G32_SFLOAT,
+        .offset = 3 * sizeof(float)
+    },
+    {
+        .location = 2,
+        .binding = 1,
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .offset = offsetof(Instance3D, transform) + 0 * sizeof(glm::vec4)
+    },
+    {
+        .location = 3,
+        .binding = 1,
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .offset = offsetof(Instance3D, transform) + 1 * sizeof(glm::vec4)
+    },
+    {
+        .location = 4,
+        .binding = 1,
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .offset = offsetof(Instance3D, transform) + 2 * sizeof(glm::vec4)
+    },
+    {
+        .location = 5,
+        .binding = 1,
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .offset = offsetof(Instance3D, transform) + 3 * sizeof(glm::vec4)
+    },
+    {
+        .location = 6,
+        .binding = 1,
+        .format = VK_FORMAT_R32G32B32A32_SFLOAT,
+        .offset = offsetof(Instance3D, color)
+    }
+}};
+
+GraphicsPipeline CreateTexture3DInstancedBindlessPipeline(VkPhysicalDevice physical_device, const Device& device, const RenderPass& render_pass,
+    const Swapchain& swapchain, const DescriptorSetLayout& camera_dsl, const DescriptorSetLayout& textures_dsl, VkSampleCountFlagBits msaa)
+{
+    const VkPipelineVertexInputStateCreateInfo vertex_input_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(INSTANCED_DESCRIPTIONS.size()),
+        .pVertexBindingDescriptions = INSTANCED_DESCRIPTIONS.data(),
+        .vertexAttributeDescriptionCount = static_cast<uint32_t>(INSTANCED_ATTRIBUTES.size()),
+        .pVertexAttributeDescriptions = INSTANCED_ATTRIBUTES.data()
+    };
+
+    const VkPipelineInputAssemblyStateCreateInfo input_assembly = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
+        .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+        .primitiveRestartEnable = VK_FALSE
+    };
+
+    const VkViewport viewport = {
+        .x = 0.0f,
+        .y = 0.0f,
+        .width = static_cast<float>(swapchain.GetWidth()),
+        .height = static_cast<float>(swapchain.GetHeight()),
+        .minDepth = 0.0f,
+        .maxDepth = 1.0f
+    };
+
+    const VkRect2D scissor = {
+        .offset = { 0, 0 },
+        .extent = swapchain.GetExtent()
+    };
+
+    const VkPipelineViewportStateCreateInfo viewport_state = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO,
+        .viewportCount = 1,
+        .pViewports = &viewport,
+        .scissorCount = 1,
+        .pScissors = &scissor
+    };
+
+    const VkPipelineRasterizationStateCreateInfo rasterizer = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO,
+        .depthClampEnable = VK_FALSE,
+        .rasterizerDiscardEnable = VK_FALSE,
+        .polygonMode = VK_POLYGON_MODE_FILL,
+        .cullMode = VK_CULL_MODE_BACK_BIT,
+        .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+        .depthBiasEnable = VK_FALSE,
+        .depthBiasConstantFactor = 0.0f,
+        .depthBiasClamp = 0.0f,
+        .depthBiasSlopeFactor = 0.0f,
+        .lineWidth = 1.0f
+    };
+
+    const VkPipelineMultisampleStateCreateInfo multisampling = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO,
+        .rasterizationSamples = msaa,
+        .sampleShadingEnable = VK_TRUE,
+        .minSampleShading = 0.2f,
+        .pSampleMask = nullptr,
+        .alphaToCoverageEnable = VK_FALSE,
+        .alphaToOneEnable = VK_FALSE
+    };
+
+    const VkPipelineColorBlendAttachmentState color_blend_attachment = {
+        .blendEnable = VK_TRUE,
+        .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
+        .dstColorBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .colorBlendOp = VK_BLEND_OP_ADD,
+        .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+        .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+        .alphaBlendOp = VK_BLEND_OP_ADD,
+        .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+            VK_COLOR_COMPONENT_A_BIT
+    };
+
+    const VkPipelineColorBlendStateCreateInfo color_blending = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO,
+        .logicOpEnable = VK_FALSE,
+        .logicOp = VK_LOGIC_OP_COPY,
+        .attachmentCount = 1,
+        .pAttachments = &color_blend_attachment,
+        .blendConstants = { 0.0f, 0.0f, 0.0f, 0.0f }
+    };
+
+    const VkPipelineDepthStencilStateCreateInfo depth_stencil = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+        .depthTestEnable = VK_TRUE,
+        .depthWriteEnable = VK_TRUE,
+        .depthCompareOp = VK_COMPARE_OP_LESS,
+        .depthBoundsTestEnable = VK_FALSE,
+        .stencilTestEnable = VK_FALSE,
+        .front = {},
+        .back = {},
+        .minDepthBounds = 0.0f,
+        .maxDepthBounds = 1.0f
+    };
+
+    // The model matrix of each draw is pushed to the vertex shader and the index of its texture to the fragment shader, the camera is read
+    // from the uniform buffer
+    const std::array<VkPushConstantRange, 2> push_constant_ranges = {{
+        {
+            .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+            .offset = 0,
+            .size = sizeof(glm::mat4)
+        },
+        {
+            .stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT,
+            .offset = sizeof(glm::mat4),
+            .size = sizeof(uint32_t)
+        }
+    }};
+
+    // Set 0 is the camera, set 1 the texture array
+    const std::array<VkDescriptorSetLayout, 2> layouts = { camera_dsl.Get(), textures_dsl.Get() };
+    const VkPipelineLayoutCreateInfo pipeline_layout_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = static_cast<uint32_t>(layouts.size()),
+        .pSetLayouts = layouts.data(),
+        .pushConstantRangeCount = static_cast<uint32_t>(push_constant_ranges.size()),
+        .pPushConstantRanges = push_constant_ranges.data()
+    };
+
+    return GraphicsPipeline(physical_device, device.Get(), VKKIT_DIRECTORY "/Shaders/Texture3DInstancedv.spv", VKKIT_DIRECTORY "/Shaders/Texture3DInstancedBindlessf.spv",
+        vertex_input_info, input_assembly, viewport_state, rasterizer, multisampling, depth_stencil, color_blending, pipeline_layout_info,
+        std::array<VkDynamicState, 2> { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR }, render_pass.Get(), 0);
+}
+}
\ No newline at end of file
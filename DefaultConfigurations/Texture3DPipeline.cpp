@@ -125,13 +125,20 @@ GraphicsPipeline CreateTexture3DPipeline(VkPhysicalDevice physical_device, const
         .maxDepthBounds = 1.0f
     };
 
+    // The model matrix of each draw is pushed, the camera is read from the uniform buffer
+    const VkPushConstantRange push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_VERTEX_BIT,
+        .offset = 0,
+        .size = sizeof(glm::mat4)
+    };
+
     const auto layout = dsl.Get();
     const VkPipelineLayoutCreateInfo pipeline_layout_info = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
         .setLayoutCount = 1,
         .pSetLayouts = &layout,
-        .pushConstantRangeCount = 0,
-        .pPushConstantRanges = nullptr
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range
     };
 
     return GraphicsPipeline(physical_device, device.Get(), VKKIT_DIRECTORY "/Shaders/Texture3Dv.spv", VKKIT_DIRECTORY "/Shaders/Texture3Df.spv",
@@ -144,7 +151,7 @@ DescriptorSetLayout CreateTexture3DLayout(const Device& device)
     static constexpr std::array<VkDescriptorSetLayoutBinding, 2> bindings = {{
         {
             .binding = 0,
-            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+            .descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC,
             .descriptorCount = 1,
             .stageFlags = VK_SHADER_STAGE_VERTEX_BIT
         },
@@ -0,0 +1,83 @@
+#include <algorithm>
+#include "DeletionQueue.h"
+
+namespace VKKit {
+DeletionQueue::DeletionQueue() noexcept :
+    current_frame{ 1 }, completed_frame{ 0 }
+{}
+
+DeletionQueue::~DeletionQueue()
+{
+    Flush();
+}
+
+void DeletionQueue::Push(Deleter deleter)
+{
+    std::scoped_lock lock(mutex);
+
+    if (buckets.empty() || buckets.back().frame != current_frame) buckets.push_back(Bucket{ current_frame, {} });
+    buckets.back().deleters.push_back(std::move(deleter));
+}
+
+DeletionQueue::Frame DeletionQueue::EndFrame()
+{
+    std::scoped_lock lock(mutex);
+    return current_frame++;
+}
+
+void DeletionQueue::Collect(Frame completed)
+{
+    std::vector<Deleter> expired;
+
+    {
+        std::scoped_lock lock(mutex);
+        completed_frame = std::max(completed_frame, completed);
+
+        while (!buckets.empty() && buckets.front().frame <= completed) {
+            auto& deleters = buckets.front().deleters;
+            expired.insert(expired.end(), std::make_move_iterator(deleters.begin()), std::make_move_iterator(deleters.end()));
+            buckets.pop_front();
+        }
+    }
+
+    // Deleters may push to the queue themselves, so they run without the lock held
+    Run(expired);
+}
+
+void DeletionQueue::Flush()
+{
+    std::vector<Deleter> expired;
+
+    {
+        std::scoped_lock lock(mutex);
+
+        for (auto& bucket : buckets)
+            expired.insert(expired.end(), std::make_move_iterator(bucket.deleters.begin()), std::make_move_iterator(bucket.deleters.end()));
+        buckets.clear();
+
+        // The device is idle, so every submitted frame has finished
+        completed_frame = current_frame - 1;
+    }
+
+    Run(expired);
+}
+
+DeletionQueue::Frame DeletionQueue::GetCurrentFrame() const
+{
+    std::scoped_lock lock(mutex);
+    return current_frame;
+}
+
+DeletionQueue::Frame DeletionQueue::GetCompletedFrame() const
+{
+    std::scoped_lock lock(mutex);
+    return completed_frame;
+}
+
+void DeletionQueue::Run(std::vector<Deleter>& deleters) noexcept
+{
+    // Resources are destroyed in the order they were pushed
+    for (auto& deleter : deleters) deleter();
+    deleters.clear();
+}
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#ifndef DELETIONQUEUE_H
+#define DELETIONQUEUE_H
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+namespace VKKit {
+// Defers the destruction of GPU resources until the frames that may still be using them have finished executing. Frames are numbered
+// from 1 upwards. A resource pushed while frame N is being recorded (or after frame N was submitted but before frame N + 1 is recorded)
+// is destroyed once the fence of frame N has signalled, which the owner of the frames reports with Collect().
+// All member functions are thread safe.
+class DeletionQueue {
+public:
+    using Frame = uint64_t;
+    using Deleter = std::move_only_function<void()>;
+
+    DeletionQueue() noexcept;
+
+    // Destroys everything still in the queue. The device must be idle.
+    ~DeletionQueue();
+
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+    DeletionQueue(DeletionQueue&&) = delete;
+    DeletionQueue& operator=(DeletionQueue&&) = delete;
+
+    // Run deleter once the current frame has finished executing
+    void Push(Deleter deleter);
+
+    // Take ownership of a resource (a Buffer, a Texture, ...) and destroy it once the current frame has finished executing
+    template<typename Resource>
+    void Defer(Resource resource)
+    {
+        Push([r = std::move(resource)]() mutable { Resource destroyed = std::move(r); });
+    }
+
+    /**
+     * @brief Mark the current frame as submitted. Resources pushed from now on belong to the next frame.
+     * @return The number of the frame that was submitted, to be passed to Collect() once its fence has signalled
+     */
+    Frame EndFrame();
+
+    // Destroy every resource that belongs to a frame up to and including completed
+    void Collect(Frame completed);
+
+    // Destroy everything in the queue. The device must be idle.
+    void Flush();
+
+    Frame GetCurrentFrame() const;
+
+    // The last frame passed to Collect(). Every frame up to and including it has finished executing.
+    Frame GetCompletedFrame() const;
+
+private:
+    struct Bucket {
+        Frame frame;
+        std::vector<Deleter> deleters;
+    };
+
+    std::deque<Bucket> buckets; // Ordered by frame
+    Frame current_frame;
+    Frame completed_frame;
+
+    mutable std::mutex mutex;
+
+    void Run(std::vector<Deleter>& deleters) noexcept;
+};
+}
+
+#endif
\ No newline at end of file
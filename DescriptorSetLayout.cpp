@@ -24,6 +24,28 @@ DescriptorSetLayout::DescriptorSetLayout(const Device& device, std::span<const V
     DescriptorSetLayout(device.Get(), bindings)
 {}
 
+DescriptorSetLayout::DescriptorSetLayout(const Device& device, VkDescriptorSetLayoutCreateFlags flags,
+    std::span<const VkDescriptorSetLayoutBinding> bindings, std::span<const VkDescriptorBindingFlags> binding_flags) :
+    device{ device.Get() }
+{
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo flags_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO,
+        .bindingCount = static_cast<uint32_t>(binding_flags.size()),
+        .pBindingFlags = binding_flags.data()
+    };
+
+    const VkDescriptorSetLayoutCreateInfo info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+        .pNext = &flags_info,
+        .flags = flags,
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    };
+
+    const auto result = vkCreateDescriptorSetLayout(this->device, &info, nullptr, &layout);
+    if (result != VK_SUCCESS) ThrowError("Failed to create descriptor set layout.", result);
+}
+
 DescriptorSetLayout::~DescriptorSetLayout()
 {
     if (device) vkDestroyDescriptorSetLayout(device, layout, nullptr);
@@ -31,6 +31,19 @@ public:
      * @throw std::runtime_error with error information on failure
      */
     DescriptorSetLayout(const Device& device, std::span<const VkDescriptorSetLayoutBinding> bindings);
+
+    /**
+     * @brief Construct a descriptor set layout with per binding flags, such as the update after bind flags that bindless descriptor arrays need
+     * 
+     * @param device The device which will work with the layout
+     * @param flags The layout creation flags
+     * @param bindings The bindings to the layout descriptions. Describes which stage of the pipeline will work with what data
+     * @param binding_flags The flags of each binding, in the order of bindings
+     * 
+     * @throw std::runtime_error with error information on failure
+     */
+    DescriptorSetLayout(const Device& device, VkDescriptorSetLayoutCreateFlags flags, std::span<const VkDescriptorSetLayoutBinding> bindings,
+        std::span<const VkDescriptorBindingFlags> binding_flags);
     
     ~DescriptorSetLayout();
 
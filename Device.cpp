@@ -1,11 +1,36 @@
 #include <expected>
 #include <vector>
+#include <algorithm>
+#include <string_view>
 #include "Device.h"
+#include "MemoryAllocator.h"
+#include "UploadQueue.h"
+#include "DeletionQueue.h"
+#include "PhysicalDevice.h"
 #include "VkResultString.h"
 
 namespace {
 struct QueueFamilies {
-    uint32_t graphics, present;
+    uint32_t graphics, present, transfer;
+};
+
+// The optional features VKKit makes use of, each enabled if the device supports it. Vulkan 1.2 devices take them in one
+// VkPhysicalDeviceVulkan12Features, which must not be chained together with the descriptor indexing structure older devices take.
+struct OptionalFeatures {
+    VkPhysicalDeviceVulkan12Features vulkan12;
+    VkPhysicalDeviceDescriptorIndexingFeatures indexing;
+    bool core12;
+    bool indexing_extension;  // Whether VK_EXT_descriptor_indexing is enabled, only on devices older than Vulkan 1.2
+    bool bindless;            // The descriptor indexing features that bindless textures need, all of them or none
+    bool draw_indirect_count; // vkCmdDrawIndexedIndirectCount
+
+    // The structure to chain to VkDeviceCreateInfo, nullptr if nothing is enabled
+    const void* GetChain() const noexcept
+    {
+        if (core12) return bindless || draw_indirect_count ? &vulkan12 : nullptr;
+        // The extension structure is only chained on devices older than Vulkan 1.2
+        return bindless ? &indexing : nullptr;
+    }
 };
 }
 
@@ -42,11 +67,121 @@ static std::expected<QueueFamilies, std::string_view> FindQueueFamilies(VkPhysic
 
     if (!found_graphics) return std::unexpected("Failed to find graphics queue");
     if (!found_present) return std::unexpected("Failed to find present queue");
+
+    // Uploads run best on a transfer only family (the copy engine), then on an async compute family. Graphics and compute families
+    // support transfers even when they don't report VK_QUEUE_TRANSFER_BIT.
+    families.transfer = families.graphics;
+    bool found_async_compute = false;
+    for (uint32_t i = 0; i < properties.size(); ++i) {
+        const VkQueueFlags flags = properties[i].queueFlags;
+        if (flags & VK_QUEUE_GRAPHICS_BIT) continue;
+
+        if (!(flags & VK_QUEUE_COMPUTE_BIT) && (flags & VK_QUEUE_TRANSFER_BIT)) {
+            families.transfer = i;
+            break;
+        }
+
+        if ((flags & VK_QUEUE_COMPUTE_BIT) && !found_async_compute) {
+            families.transfer = i;
+            found_async_compute = true;
+        }
+    }
+
     return families;
 }
 
+static bool IsExtensionSupported(VkPhysicalDevice physical_device, std::string_view name)
+{
+    uint32_t count;
+    vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &count, nullptr);
+
+    std::vector<VkExtensionProperties> available(count);
+    vkEnumerateDeviceExtensionProperties(physical_device, nullptr, &count, available.data());
+
+    return std::any_of(available.begin(), available.end(), [name](const VkExtensionProperties& e) { return name == e.extensionName; });
+}
+
+// Add extension to enabled if the device supports it and it isn't there yet. Returns whether the device supports it.
+static bool EnableOptionalExtension(VkPhysicalDevice physical_device, std::vector<const char*>& enabled, std::string_view extension)
+{
+    if (!IsExtensionSupported(physical_device, extension)) return false;
+
+    const bool requested = std::any_of(enabled.begin(), enabled.end(), [extension](const char* e) { return extension == e; });
+    if (!requested) enabled.push_back(extension.data());
+    return true;
+}
+
+// The requested extensions, plus the optional ones VKKit makes use of when the device has them
+static std::vector<const char*> GetEnabledExtensions(VkPhysicalDevice physical_device, std::span<const char* const> extensions,
+    const OptionalFeatures& optional, bool& memory_budget)
+{
+    std::vector<const char*> enabled(extensions.begin(), extensions.end());
+
+    memory_budget = EnableOptionalExtension(physical_device, enabled, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
+    // Descriptor indexing is core since Vulkan 1.2. Enabling the extension there would require VkPhysicalDeviceVulkan12Features to
+    // enable descriptorIndexing as a whole.
+    if (optional.indexing_extension) EnableOptionalExtension(physical_device, enabled, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+    return enabled;
+}
+
+static OptionalFeatures GetOptionalFeatures(VkPhysicalDevice physical_device)
+{
+    OptionalFeatures optional{};
+    optional.core12 = GetPhysicalDeviceProperties(physical_device).apiVersion >= VK_API_VERSION_1_2;
+    optional.indexing_extension = !optional.core12 && IsExtensionSupported(physical_device, VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME);
+
+    // Only one of the two structures is queried, they must not be in the same chain
+    VkPhysicalDeviceVulkan12Features supported12 = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES };
+    VkPhysicalDeviceDescriptorIndexingFeatures supported = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES };
+    VkPhysicalDeviceFeatures2 features = { .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2 };
+    if (optional.core12) features.pNext = &supported12;
+    else if (optional.indexing_extension) features.pNext = &supported;
+    vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+    // The 3D bindless shaders index the texture array with a push constant, which needs dynamic indexing
+    const bool dynamic_indexing = features.features.shaderSampledImageArrayDynamicIndexing;
+
+    if (optional.core12) {
+        optional.bindless = dynamic_indexing && supported12.shaderSampledImageArrayNonUniformIndexing &&
+            supported12.descriptorBindingSampledImageUpdateAfterBind && supported12.descriptorBindingUpdateUnusedWhilePending &&
+            supported12.descriptorBindingPartiallyBound && supported12.runtimeDescriptorArray;
+    }
+    else if (optional.indexing_extension) {
+        optional.bindless = dynamic_indexing && supported.shaderSampledImageArrayNonUniformIndexing &&
+            supported.descriptorBindingSampledImageUpdateAfterBind && supported.descriptorBindingUpdateUnusedWhilePending &&
+            supported.descriptorBindingPartiallyBound && supported.runtimeDescriptorArray;
+    }
+
+    optional.draw_indirect_count = optional.core12 && supported12.drawIndirectCount;
+
+    const VkBool32 bindless = optional.bindless;
+    optional.vulkan12 = VkPhysicalDeviceVulkan12Features {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES,
+        .drawIndirectCount = optional.draw_indirect_count,
+        .shaderSampledImageArrayNonUniformIndexing = bindless,
+        .descriptorBindingSampledImageUpdateAfterBind = bindless,
+        .descriptorBindingUpdateUnusedWhilePending = bindless,
+        .descriptorBindingPartiallyBound = bindless,
+        .runtimeDescriptorArray = bindless
+    };
+
+    optional.indexing = VkPhysicalDeviceDescriptorIndexingFeatures {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES,
+        .shaderSampledImageArrayNonUniformIndexing = bindless,
+        .descriptorBindingSampledImageUpdateAfterBind = bindless,
+        .descriptorBindingUpdateUnusedWhilePending = bindless,
+        .descriptorBindingPartiallyBound = bindless,
+        .runtimeDescriptorArray = bindless
+    };
+
+    return optional;
+}
+
 Device::Device() noexcept :
-    device{ nullptr }, graphics_queue_index{ 0 }, present_queue_index{ 0 }, graphics_queue{ nullptr }, present_queue{ nullptr }
+    device{ nullptr }, graphics_queue_index{ 0 }, present_queue_index{ 0 }, transfer_queue_index{ 0 }, graphics_queue{ nullptr },
+    present_queue{ nullptr }, transfer_queue{ nullptr }, bindless{ false }, draw_indirect_count{ false }
 {}
 
 Device::Device(VkPhysicalDevice physical_device, const VkPhysicalDeviceFeatures& features, VkSurfaceKHR surface,
@@ -57,27 +192,42 @@ Device::Device(VkPhysicalDevice physical_device, const VkPhysicalDeviceFeatures&
         ThrowError("Failed to find queue family.", indices.error());
     graphics_queue_index = indices->graphics;
     present_queue_index = indices->present;
+    transfer_queue_index = indices->transfer;
 
-    const uint32_t families = graphics_queue_index == present_queue_index ? 1 : 2;
+    uint32_t families = 0;
     const float priority = 1.0f;
-    std::array<VkDeviceQueueCreateInfo, 2> queue_create_infos;
+    std::array<VkDeviceQueueCreateInfo, 3> queue_create_infos;
+
+    for (const uint32_t family : { graphics_queue_index, present_queue_index, transfer_queue_index }) {
+        const auto end = queue_create_infos.begin() + families;
+        if (std::find_if(queue_create_infos.begin(), end, [family](const auto& q) { return q.queueFamilyIndex == family; }) != end) continue;
 
-    for (uint32_t i = 0; i < families; ++i) {
-        queue_create_infos[i] = VkDeviceQueueCreateInfo {
+        queue_create_infos[families++] = VkDeviceQueueCreateInfo {
             .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-            .queueFamilyIndex = i == 0 ? graphics_queue_index : present_queue_index,
+            .queueFamilyIndex = family,
             .queueCount = 1,
             .pQueuePriorities = &priority
         };
     }
 
+    const OptionalFeatures optional = GetOptionalFeatures(physical_device);
+    bindless = optional.bindless;
+    draw_indirect_count = optional.draw_indirect_count;
+
+    bool memory_budget;
+    const auto enabled_extensions = GetEnabledExtensions(physical_device, extensions, optional, memory_budget);
+
+    VkPhysicalDeviceFeatures enabled_features = features;
+    if (bindless) enabled_features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
     const VkDeviceCreateInfo info = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = optional.GetChain(),
         .queueCreateInfoCount = families,
         .pQueueCreateInfos = queue_create_infos.data(),
-        .enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
-        .ppEnabledExtensionNames = extensions.data(),
-        .pEnabledFeatures = &features
+        .enabledExtensionCount = static_cast<uint32_t>(enabled_extensions.size()),
+        .ppEnabledExtensionNames = enabled_extensions.data(),
+        .pEnabledFeatures = &enabled_features
     };
 
     const auto result = vkCreateDevice(physical_device, &info, nullptr, &device);
@@ -85,6 +235,11 @@ Device::Device(VkPhysicalDevice physical_device, const VkPhysicalDeviceFeatures&
 
     vkGetDeviceQueue(device, graphics_queue_index, 0, &graphics_queue);
     vkGetDeviceQueue(device, present_queue_index, 0, &present_queue);
+    vkGetDeviceQueue(device, transfer_queue_index, 0, &transfer_queue);
+
+    allocator = std::make_unique<MemoryAllocator>(physical_device, device, memory_budget);
+    upload_queue = std::make_unique<UploadQueue>(device, *allocator, transfer_queue_index, transfer_queue, graphics_queue_index, graphics_queue);
+    deletion_queue = std::make_unique<DeletionQueue>();
 }
 
 #ifndef NDEBUG
@@ -96,29 +251,44 @@ Device::Device(VkPhysicalDevice physical_device, const VkPhysicalDeviceFeatures&
         ThrowError("Failed to find queue family.", indices.error());
     graphics_queue_index = indices->graphics;
     present_queue_index = indices->present;
+    transfer_queue_index = indices->transfer;
 
-    const uint32_t families = graphics_queue_index == present_queue_index ? 1 : 2;
+    uint32_t families = 0;
     const float priority = 1.0f;
-    std::array<VkDeviceQueueCreateInfo, 2> queue_create_infos;
+    std::array<VkDeviceQueueCreateInfo, 3> queue_create_infos;
+
+    for (const uint32_t family : { graphics_queue_index, present_queue_index, transfer_queue_index }) {
+        const auto end = queue_create_infos.begin() + families;
+        if (std::find_if(queue_create_infos.begin(), end, [family](const auto& q) { return q.queueFamilyIndex == family; }) != end) continue;
 
-    for (uint32_t i = 0; i < families; ++i) {
-        queue_create_infos[i] = VkDeviceQueueCreateInfo {
+        queue_create_infos[families++] = VkDeviceQueueCreateInfo {
             .sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-            .queueFamilyIndex = i == 0 ? graphics_queue_index : present_queue_index,
+            .queueFamilyIndex = family,
             .queueCount = 1,
             .pQueuePriorities = &priority
         };
     }
 
+    const OptionalFeatures optional = GetOptionalFeatures(physical_device);
+    bindless = optional.bindless;
+    draw_indirect_count = optional.draw_indirect_count;
+
+    bool memory_budget;
+    const auto enabled_extensions = GetEnabledExtensions(physical_device, extensions, optional, memory_budget);
+
+    VkPhysicalDeviceFeatures enabled_features = features;
+    if (bindless) enabled_features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
     const VkDeviceCreateInfo info = {
         .sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+        .pNext = optional.GetChain(),
         .queueCreateInfoCount = families,
         .pQueueCreateInfos = queue_create_infos.data(),
         .enabledLayerCount = static_cast<uint32_t>(validation_layers.size()),
         .ppEnabledLayerNames = validation_layers.data(),
-        .enabledExtensionCount = static_cast<uint32_t>(extensions.size()),
-        .ppEnabledExtensionNames = extensions.data(),
-        .pEnabledFeatures = &features
+        .enabledExtensionCount = static_cast<uint32_t>(enabled_extensions.size()),
+        .ppEnabledExtensionNames = enabled_extensions.data(),
+        .pEnabledFeatures = &enabled_features
     };
 
     const auto result = vkCreateDevice(physical_device, &info, nullptr, &device);
@@ -126,34 +296,56 @@ Device::Device(VkPhysicalDevice physical_device, const VkPhysicalDeviceFeatures&
 
     vkGetDeviceQueue(device, graphics_queue_index, 0, &graphics_queue);
     vkGetDeviceQueue(device, present_queue_index, 0, &present_queue);
+    vkGetDeviceQueue(device, transfer_queue_index, 0, &transfer_queue);
+
+    allocator = std::make_unique<MemoryAllocator>(physical_device, device, memory_budget);
+    upload_queue = std::make_unique<UploadQueue>(device, *allocator, transfer_queue_index, transfer_queue, graphics_queue_index, graphics_queue);
+    deletion_queue = std::make_unique<DeletionQueue>();
 }
 #endif
 
 Device::~Device()
 {
+    deletion_queue.reset(); // Deferred resources may hold on to allocator memory and staging buffers
+    upload_queue.reset();
+    allocator.reset();
     vkDestroyDevice(device, nullptr);
 }
 
 Device::Device(Device&& d) noexcept :
     device{ d.device }, graphics_queue_index{ d.graphics_queue_index }, present_queue_index{ d.present_queue_index},
-    graphics_queue{ d.graphics_queue }, present_queue{ d.present_queue }
+    transfer_queue_index{ d.transfer_queue_index }, graphics_queue{ d.graphics_queue }, present_queue{ d.present_queue },
+    transfer_queue{ d.transfer_queue }, bindless{ d.bindless }, draw_indirect_count{ d.draw_indirect_count },
+    allocator{ std::move(d.allocator) }, upload_queue{ std::move(d.upload_queue) }, deletion_queue{ std::move(d.deletion_queue) }
 {
     d.device = nullptr;
     d.graphics_queue = nullptr;
     d.present_queue = nullptr;
+    d.transfer_queue = nullptr;
 }
 
 Device& Device::operator=(Device&& d) noexcept
 {
+    deletion_queue.reset(); // Deferred resources may hold on to allocator memory and staging buffers
+    upload_queue.reset();
+    allocator.reset();
     vkDestroyDevice(device, nullptr);
     device = d.device;
     graphics_queue_index = d.graphics_queue_index;
     present_queue_index = d.present_queue_index;
+    transfer_queue_index = d.transfer_queue_index;
     graphics_queue = d.graphics_queue;
     present_queue = d.present_queue;
+    transfer_queue = d.transfer_queue;
+    bindless = d.bindless;
+    draw_indirect_count = d.draw_indirect_count;
+    allocator = std::move(d.allocator);
+    upload_queue = std::move(d.upload_queue);
+    deletion_queue = std::move(d.deletion_queue);
     d.device = nullptr;
     d.graphics_queue = nullptr;
     d.present_queue = nullptr;
+    d.transfer_queue = nullptr;
     return *this;
 }
 
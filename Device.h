@@ -2,9 +2,14 @@
 #define VULKANDEVICE_H
 
 #include <span>
+#include <memory>
 #include "vulkan/vulkan.hpp"
 
 namespace VKKit {
+class MemoryAllocator;
+class UploadQueue;
+class DeletionQueue;
+
 // Vulkan logical device. Wrapper around VkDevice.
 class Device {
 public:
@@ -52,12 +57,37 @@ public:
     VkQueue GetGraphicsQueue() const noexcept { return graphics_queue; }
     VkQueue GetPresentQueue() const noexcept { return present_queue; }
 
+    // The family of the queue used for uploads. This is a transfer only or async compute family if the device has one, otherwise it is
+    // the graphics family.
+    uint32_t GetTransferQueueIndex() const noexcept { return transfer_queue_index; }
+    VkQueue GetTransferQueue() const noexcept { return transfer_queue; }
+
+    // The allocator that device memory for buffers is sub-allocated from
+    MemoryAllocator& GetAllocator() const noexcept { return *allocator; }
+
+    // The queue that staging copies are batched into. Copies run on the transfer queue.
+    UploadQueue& GetUploadQueue() const noexcept { return *upload_queue; }
+
+    // The queue that resources which may still be in use by frames in flight are destroyed through
+    DeletionQueue& GetDeletionQueue() const noexcept { return *deletion_queue; }
+
+    // Whether the descriptor indexing features that bindless textures need are enabled. They are enabled whenever the device supports them.
+    bool SupportsBindless() const noexcept { return bindless; }
+
+    // Whether the drawIndirectCount feature is enabled, which it is whenever the device supports it
+    bool SupportsDrawIndirectCount() const noexcept { return draw_indirect_count; }
+
     void Wait() const noexcept;
 
 private:
     VkDevice device;
-    uint32_t graphics_queue_index, present_queue_index;
-    VkQueue graphics_queue, present_queue;
+    uint32_t graphics_queue_index, present_queue_index, transfer_queue_index;
+    VkQueue graphics_queue, present_queue, transfer_queue;
+    bool bindless;
+    bool draw_indirect_count;
+    std::unique_ptr<MemoryAllocator> allocator;
+    std::unique_ptr<UploadQueue> upload_queue;
+    std::unique_ptr<DeletionQueue> deletion_queue;
 };
 }
 
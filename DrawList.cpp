@@ -0,0 +1,61 @@
+#include <array>
+#include <bit>
+#include <algorithm>
+#include "DrawList.h"
+
+namespace VKKit {
+static constexpr uint32_t DEPTH_SHIFT = 0;
+static constexpr uint32_t TEXTURE_SHIFT = DEPTH_SHIFT + DrawList::DEPTH_BITS;
+static constexpr uint32_t PIPELINE_SHIFT = TEXTURE_SHIFT + DrawList::TEXTURE_BITS;
+static constexpr uint32_t SEQUENCE_SHIFT = PIPELINE_SHIFT + DrawList::PIPELINE_BITS;
+static constexpr uint32_t LAYER_SHIFT = SEQUENCE_SHIFT + DrawList::SEQUENCE_BITS;
+
+static constexpr uint64_t Field(uint32_t value, uint32_t bits, uint32_t shift) noexcept
+{
+    return (static_cast<uint64_t>(value) & ((uint64_t{ 1 } << bits) - 1)) << shift;
+}
+
+uint64_t DrawList::MakeKey(uint32_t layer, uint32_t sequence, uint32_t pipeline, uint32_t texture, float depth) noexcept
+{
+    // Wrapping around would put the last draws of a long layer under the first ones
+    sequence = std::min(sequence, (uint32_t{ 1 } << SEQUENCE_BITS) - 1);
+
+    // The bit patterns of non-negative floats sort like the floats themselves, so the top bits are a coarse but ordered depth
+    const uint32_t depth_bits = depth > 0.0f ? std::bit_cast<uint32_t>(depth) >> (32 - DEPTH_BITS) : 0;
+
+    return Field(layer, LAYER_BITS, LAYER_SHIFT) | Field(sequence, SEQUENCE_BITS, SEQUENCE_SHIFT) | Field(pipeline, PIPELINE_BITS, PIPELINE_SHIFT) |
+        Field(texture, TEXTURE_BITS, TEXTURE_SHIFT) | Field(depth_bits, DEPTH_BITS, DEPTH_SHIFT);
+}
+
+void DrawList::Sort()
+{
+    static constexpr size_t DIGITS = sizeof(uint64_t);
+    static constexpr size_t RADIX = 256;
+
+    if (entries.size() < 2) return;
+
+    // Count every digit in one pass over the keys
+    std::array<std::array<uint32_t, RADIX>, DIGITS> counts = {};
+    for (const Entry& e : entries)
+        for (size_t d = 0; d < DIGITS; ++d) ++counts[d][(e.key >> (d * 8)) & 0xFF];
+
+    scratch.resize(entries.size());
+
+    for (size_t d = 0; d < DIGITS; ++d) {
+        auto& count = counts[d];
+
+        // A digit that is the same in every key doesn't change the order
+        if (std::ranges::find(count, static_cast<uint32_t>(entries.size())) != count.end()) continue;
+
+        uint32_t offset = 0;
+        for (auto& c : count) {
+            const uint32_t n = c;
+            c = offset;
+            offset += n;
+        }
+
+        for (const Entry& e : entries) scratch[count[(e.key >> (d * 8)) & 0xFF]++] = e;
+        entries.swap(scratch);
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+#ifndef DRAWLIST_H
+#define DRAWLIST_H
+
+#include <vector>
+#include <span>
+#include <cstdint>
+
+namespace VKKit {
+// A list of draw commands tagged with 64-bit sort keys. The list only stores the keys and an index into the owner's command storage, the
+// owner records the commands in sorted order.
+//
+// Key layout, from the most significant bits down:
+// | layer (8) | sequence (20) | pipeline (4) | texture (16) | depth (16) |
+// The sequence keeps the draws of a layer in the order they were added in. Draws that may be reordered (opaque, depth tested ones) share
+// a sequence number and are sorted by state within it, draws that blend over what is below them each get their own.
+// Sorting is stable, so commands with equal keys keep the order they were added in.
+class DrawList {
+public:
+    static constexpr uint32_t LAYER_BITS = 8;
+    static constexpr uint32_t SEQUENCE_BITS = 20;
+    static constexpr uint32_t PIPELINE_BITS = 4;
+    static constexpr uint32_t TEXTURE_BITS = 16;
+    static constexpr uint32_t DEPTH_BITS = 16;
+
+    struct Entry {
+        uint64_t key;
+        uint32_t command; // Index of the command in the owner's storage
+    };
+
+    /**
+     * @brief Build a sort key. Fields wider than their bits are truncated, except for the sequence, which saturates.
+     * @param layer Layers are drawn in increasing order
+     * @param sequence The position of the draw in its layer. Draws with a lower sequence are drawn first.
+     * @param pipeline The pipeline of the draw, draws of a layer and sequence are grouped by it
+     * @param texture The texture or descriptor of the draw, draws of a layer, sequence and pipeline are grouped by it
+     * @param depth The distance from the camera, closer draws come first. Negative values count as 0.
+     */
+    static uint64_t MakeKey(uint32_t layer, uint32_t sequence, uint32_t pipeline, uint32_t texture, float depth) noexcept;
+
+    void Add(uint64_t key, uint32_t command) { entries.push_back(Entry{ key, command }); }
+
+    // Sort the entries by key with a least significant digit radix sort. Digits that are equal in every key are skipped.
+    void Sort();
+
+    std::span<const Entry> GetEntries() const noexcept { return entries; }
+    size_t Size() const noexcept { return entries.size(); }
+    bool Empty() const noexcept { return entries.empty(); }
+    void Clear() noexcept { entries.clear(); }
+
+    // Remove the entries that remove(entry) is true for. The others keep their order.
+    template<typename F>
+    void RemoveIf(F&& remove) { std::erase_if(entries, remove); }
+
+private:
+    std::vector<Entry> entries;
+    std::vector<Entry> scratch;
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include "Frustum.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define VKKIT_CULL_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VKKIT_CULL_SSE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VKKIT_CULL_NEON
+#endif
+
+namespace VKKit {
+Frustum Frustum::FromMatrix(const glm::mat4& matrix) noexcept
+{
+    // glm matrices are column major, so row i is matrix[column][i]
+    auto row = [&](int i) { return glm::vec4(matrix[0][i], matrix[1][i], matrix[2][i], matrix[3][i]); };
+
+    Frustum frustum = {{
+        row(3) + row(0),
+        row(3) - row(0),
+        row(3) + row(1),
+        row(3) - row(1),
+        row(2),
+        row(3) - row(2)
+    }};
+
+    for (auto& p : frustum.planes) p /= glm::length(glm::vec3(p));
+
+    return frustum;
+}
+
+Frustum Frustum::FromCamera(const CameraView& camera) noexcept
+{
+    return FromMatrix(camera.proj * camera.view * camera.model);
+}
+
+bool Frustum::Intersects(glm::vec3 min, glm::vec3 max) const noexcept
+{
+    // The box is outside a plane if its corner furthest along the plane's normal is
+    for (const auto& p : planes) {
+        const glm::vec3 corner = { p.x >= 0.0f ? max.x : min.x, p.y >= 0.0f ? max.y : min.y, p.z >= 0.0f ? max.z : min.z };
+        if (glm::dot(glm::vec3(p), corner) + p.w < 0.0f) return false;
+    }
+
+    return true;
+}
+
+bool Frustum::Intersects(const Cuboid& cuboid) const noexcept
+{
+    return Intersects(glm::vec3(cuboid.x, cuboid.y, cuboid.z), glm::vec3(cuboid.x + cuboid.w, cuboid.y + cuboid.h, cuboid.z + cuboid.d));
+}
+
+void Frustum::Intersects(const BoxBatch& boxes, size_t first, std::span<uint8_t> visible) const noexcept
+{
+    // The corner furthest along a plane's normal is the same for every box, so each plane reads one array per axis. corners[p][axis] is
+    // the array of that corner's coordinate.
+    std::array<std::array<const float*, 3>, 6> corners;
+    for (size_t p = 0; p < planes.size(); ++p) {
+        corners[p][0] = (planes[p].x >= 0.0f ? boxes.max_x : boxes.min_x).data() + first;
+        corners[p][1] = (planes[p].y >= 0.0f ? boxes.max_y : boxes.min_y).data() + first;
+        corners[p][2] = (planes[p].z >= 0.0f ? boxes.max_z : boxes.min_z).data() + first;
+    }
+
+    const size_t count = visible.size();
+    size_t i = 0;
+
+#if defined(VKKIT_CULL_AVX)
+    for (; i + 8 <= count; i += 8) {
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (size_t p = 0; p < planes.size(); ++p) {
+            __m256 distance = _mm256_set1_ps(planes[p].w);
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(planes[p].x), _mm256_loadu_ps(corners[p][0] + i)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(planes[p].y), _mm256_loadu_ps(corners[p][1] + i)));
+            distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(planes[p].z), _mm256_loadu_ps(corners[p][2] + i)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        const int mask = _mm256_movemask_ps(inside);
+        for (size_t k = 0; k < 8; ++k) visible[i + k] = (mask >> k) & 1;
+    }
+#elif defined(VKKIT_CULL_SSE)
+    for (; i + 4 <= count; i += 4) {
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (size_t p = 0; p < planes.size(); ++p) {
+            __m128 distance = _mm_set1_ps(planes[p].w);
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p].x), _mm_loadu_ps(corners[p][0] + i)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p].y), _mm_loadu_ps(corners[p][1] + i)));
+            distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(planes[p].z), _mm_loadu_ps(corners[p][2] + i)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+        }
+
+        const int mask = _mm_movemask_ps(inside);
+        for (size_t k = 0; k < 4; ++k) visible[i + k] = (mask >> k) & 1;
+    }
+#elif defined(VKKIT_CULL_NEON)
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t inside = vdupq_n_u32(~0u);
+
+        for (size_t p = 0; p < planes.size(); ++p) {
+            float32x4_t distance = vdupq_n_f32(planes[p].w);
+            distance = vmlaq_n_f32(distance, vld1q_f32(corners[p][0] + i), planes[p].x);
+            distance = vmlaq_n_f32(distance, vld1q_f32(corners[p][1] + i), planes[p].y);
+            distance = vmlaq_n_f32(distance, vld1q_f32(corners[p][2] + i), planes[p].z);
+            inside = vandq_u32(inside, vcgeq_f32(distance, vdupq_n_f32(0.0f)));
+        }
+
+        std::array<uint32_t, 4> mask;
+        vst1q_u32(mask.data(), inside);
+        for (size_t k = 0; k < 4; ++k) visible[i + k] = mask[k] != 0;
+    }
+#endif
+
+    // The boxes left over, or every box without SIMD instructions
+    for (; i < count; ++i) {
+        bool inside = true;
+        for (size_t p = 0; p < planes.size() && inside; ++p)
+            inside = planes[p].x * corners[p][0][i] + planes[p].y * corners[p][1][i] + planes[p].z * corners[p][2][i] + planes[p].w >= 0.0f;
+        visible[i] = inside;
+    }
+}
+
+void BoxBatch::Add(glm::vec3 min, glm::vec3 max)
+{
+    min_x.push_back(min.x);
+    min_y.push_back(min.y);
+    min_z.push_back(min.z);
+    max_x.push_back(max.x);
+    max_y.push_back(max.y);
+    max_z.push_back(max.z);
+}
+
+void BoxBatch::Add(const Cuboid& cuboid)
+{
+    Add(glm::vec3(cuboid.x, cuboid.y, cuboid.z), glm::vec3(cuboid.x + cuboid.w, cuboid.y + cuboid.h, cuboid.z + cuboid.d));
+}
+
+void BoxBatch::Clear() noexcept
+{
+    min_x.clear();
+    min_y.clear();
+    min_z.clear();
+    max_x.clear();
+    max_y.clear();
+    max_z.clear();
+}
+}
\ No newline at end of file
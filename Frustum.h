@@ -0,0 +1,55 @@
+#ifndef FRUSTUM_H
+#define FRUSTUM_H
+
+#include <array>
+#include <vector>
+#include <span>
+#include <cstdint>
+#include "glm/glm.hpp"
+#include "RenderData.h"
+
+namespace VKKit {
+class BoxBatch;
+
+// The six planes that bound what a camera sees. Each plane is (normal, distance) with the normal pointing into the frustum, so a point p
+// is on the inner side of a plane when dot(normal, p) + distance >= 0.
+struct Frustum {
+    std::array<glm::vec4, 6> planes; // Left, right, bottom, top, near, far
+
+    // The frustum of a clip space matrix with a depth range of 0 to 1, in the space the matrix transforms from
+    static Frustum FromMatrix(const glm::mat4& matrix) noexcept;
+
+    // The frustum of camera in the space its model matrix transforms from, the space instance transforms and cuboids are given in
+    static Frustum FromCamera(const CameraView& camera) noexcept;
+
+    // Does any part of the axis aligned box from min to max lie inside the frustum? Boxes near a corner may pass without being visible.
+    bool Intersects(glm::vec3 min, glm::vec3 max) const noexcept;
+    bool Intersects(const Cuboid& cuboid) const noexcept;
+
+    /**
+     * @brief Test boxes [first, first + visible.size()) of a batch at once, several boxes per instruction where the CPU has SIMD
+     *        instructions (SSE2 or NEON, or AVX when built with VKKIT_ENABLE_AVX). The results are the same as those of testing each box on its own.
+     * @param boxes The boxes
+     * @param first The first box tested
+     * @param visible Set to 1 for every box that intersects the frustum and to 0 for the others
+     */
+    void Intersects(const BoxBatch& boxes, size_t first, std::span<uint8_t> visible) const noexcept;
+};
+
+// Axis aligned boxes stored as one array per coordinate, so a frustum can test consecutive boxes with one SIMD instruction
+class BoxBatch {
+public:
+    void Add(glm::vec3 min, glm::vec3 max);
+    void Add(const Cuboid& cuboid);
+    void Clear() noexcept;
+
+    size_t Size() const noexcept { return min_x.size(); }
+
+private:
+    friend struct Frustum;
+
+    std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+};
+}
+
+#endif
\ No newline at end of file
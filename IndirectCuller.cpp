@@ -0,0 +1,147 @@
+#include <algorithm>
+#include "IndirectCuller.h"
+#include "VkResultString.h"
+#include "PhysicalDevice.h"
+#include "RenderData.h"
+#include "Frustum.h"
+#include "Device.h"
+
+namespace VKKit {
+// Matches the push constants of Cull.comp
+struct CullConstants {
+    std::array<glm::vec4, 6> planes;
+    uint32_t instance_count;
+    uint32_t run_count;
+};
+
+IndirectCuller::IndirectCuller() noexcept :
+    device{ nullptr }, alignment{ 0 }, current_frame{ 0 }
+{}
+
+IndirectCuller::IndirectCuller(VkPhysicalDevice physical_device, const Device& device) :
+    device{ device.Get() }, current_frame{ 0 }
+{
+    // The storage offsets also have to be aligned to the elements written through the ring buffer's mapping
+    alignment = std::max<VkDeviceSize>(GetPhysicalDeviceProperties(physical_device).limits.minStorageBufferOffsetAlignment, 16);
+
+    // Instances, runs, commands, visible instances, draw counts
+    std::array<VkDescriptorSetLayoutBinding, 5> bindings;
+    for (uint32_t i = 0; i < bindings.size(); ++i) {
+        bindings[i] = VkDescriptorSetLayoutBinding {
+            .binding = i,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = 1,
+            .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+            .pImmutableSamplers = nullptr
+        };
+    }
+
+    layout = DescriptorSetLayout(device, bindings);
+
+    const std::array<VkDescriptorPoolSize, 1> pool_sizes = {
+        VkDescriptorPoolSize {
+            .type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .descriptorCount = static_cast<uint32_t>(bindings.size()) * MAX_JOBS_PER_FRAME
+        }
+    };
+
+    for (auto& p : pools) p = DescriptorPool(device, {}, pool_sizes, 1);
+
+    const VkPushConstantRange push_constant_range = {
+        .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+        .offset = 0,
+        .size = sizeof(CullConstants)
+    };
+
+    const auto set_layout = layout.Get();
+    const VkPipelineLayoutCreateInfo pipeline_layout_info = {
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO,
+        .setLayoutCount = 1,
+        .pSetLayouts = &set_layout,
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &push_constant_range
+    };
+
+    pipeline = ComputePipeline(device.Get(), VKKIT_DIRECTORY "/Shaders/Cullc.spv", pipeline_layout_info);
+}
+
+void IndirectCuller::BeginFrame(uint32_t frame) noexcept
+{
+    current_frame = frame;
+    pools[frame].Reset();
+}
+
+IndirectCuller::Job IndirectCuller::Cull(VkCommandBuffer command_buffer, RingBuffer& buffers, VkBuffer instances, uint32_t instance_count,
+    std::span<const Run> runs, const Frustum& frustum)
+{
+    // The commands start without instances, the shader counts the visible ones into them
+    const auto commands = buffers.Allocate(runs.size() * sizeof(VkDrawIndexedIndirectCommand), alignment);
+    auto* const command = static_cast<VkDrawIndexedIndirectCommand*>(commands.data);
+    for (size_t i = 0; i < runs.size(); ++i)
+        command[i] = VkDrawIndexedIndirectCommand{ .indexCount = runs[i].index_count, .instanceCount = 0, .firstIndex = 0, .vertexOffset = 0,
+            .firstInstance = 0 };
+
+    // So do the draw counts, which the shader sets when it finds a run's first visible instance
+    const auto counts = buffers.Allocate(runs.size() * sizeof(uint32_t), alignment);
+    std::fill_n(static_cast<uint32_t*>(counts.data), runs.size(), 0);
+
+    const auto run_range = buffers.Push(runs.data(), runs.size_bytes(), alignment);
+    const auto visible = buffers.Allocate(instance_count * sizeof(Instance3D), alignment);
+
+    const VkDescriptorSetLayout set_layout = layout.Get();
+    const VkDescriptorSetAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+        .descriptorPool = pools[current_frame].Get(),
+        .descriptorSetCount = 1,
+        .pSetLayouts = &set_layout
+    };
+
+    VkDescriptorSet set;
+    const auto result = vkAllocateDescriptorSets(device, &alloc_info, &set);
+    if (result != VK_SUCCESS) ThrowError("Failed to create culling descriptor set. Too many culling jobs in one frame.", result);
+
+    const std::array<VkDescriptorBufferInfo, 5> buffer_infos = {{
+        { instances, 0, instance_count * sizeof(Instance3D) },
+        { run_range.buffer, run_range.offset, runs.size_bytes() },
+        { commands.buffer, commands.offset, runs.size() * sizeof(VkDrawIndexedIndirectCommand) },
+        { visible.buffer, visible.offset, instance_count * sizeof(Instance3D) },
+        { counts.buffer, counts.offset, runs.size() * sizeof(uint32_t) }
+    }};
+
+    std::array<VkWriteDescriptorSet, 5> writes;
+    for (uint32_t i = 0; i < writes.size(); ++i) {
+        writes[i] = VkWriteDescriptorSet {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = set,
+            .dstBinding = i,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+            .pBufferInfo = &buffer_infos[i]
+        };
+    }
+
+    vkUpdateDescriptorSets(device, static_cast<uint32_t>(writes.size()), writes.data(), 0, nullptr);
+
+    const CullConstants constants = { frustum.planes, instance_count, static_cast<uint32_t>(runs.size()) };
+
+    vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.GetPipeline());
+    vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline.GetLayout(), 0, 1, &set, 0, nullptr);
+    vkCmdPushConstants(command_buffer, pipeline.GetLayout(), VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(constants), &constants);
+    vkCmdDispatch(command_buffer, (instance_count + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    return Job{ commands, counts, visible };
+}
+
+void IndirectCuller::Barrier(VkCommandBuffer command_buffer) noexcept
+{
+    const VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+    };
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+        VK_PIPELINE_STAGE_VERTEX_INPUT_BIT, 0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#ifndef INDIRECTCULLER_H
+#define INDIRECTCULLER_H
+
+#include <span>
+#include <array>
+#include <cstdint>
+#include "vulkan/vulkan.h"
+#include "glm/glm.hpp"
+#include "DescriptorSetLayout.h"
+#include "DescriptorPool.h"
+#include "ComputePipeline.h"
+#include "RingBuffer.h"
+#include "Constants.h"
+
+namespace VKKit {
+class Device;
+struct Frustum;
+
+// Culls instances against a frustum in a compute shader, which writes the indirect draw commands that draw the visible ones. The
+// instances are split into runs (such as the runs of a RetainedScene pool) that are each drawn with one command. The shader copies the
+// visible instances of a run to the start of the run's range in an output buffer and counts them into the run's command, so the CPU never
+// looks at the instances.
+class IndirectCuller {
+public:
+    static constexpr uint32_t MAX_JOBS_PER_FRAME = 64;
+    static constexpr uint32_t WORKGROUP_SIZE = 64; // Must match local_size_x of Cull.comp
+
+    // Instances [first, first + count) drawn with one command. Matches the Run struct of Cull.comp.
+    struct Run {
+        glm::vec4 bounds_min; // The box around the mesh the instances draw, before their transform
+        glm::vec4 bounds_max;
+        uint32_t first;
+        uint32_t count;
+        uint32_t index_count; // The number of indices of the mesh
+        uint32_t padding;
+    };
+
+    // Where the results of a Cull are, in the ring buffer that was passed to it
+    struct Job {
+        RingBuffer::Range commands; // One VkDrawIndexedIndirectCommand per run, in order
+        RingBuffer::Range counts;   // One draw count per command for vkCmdDrawIndexedIndirectCount, 0 if the run has no visible instances
+        RingBuffer::Range visible;  // The visible instances of each run, starting at the run's first instance
+    };
+
+    IndirectCuller() noexcept;
+
+    /**
+     * @brief Create the culling pipeline and its descriptor pools
+     *
+     * @param physical_device The physical device used, whose storage buffer offset alignment the ranges are aligned to
+     * @param device The logical device used
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    IndirectCuller(VkPhysicalDevice physical_device, const Device& device);
+
+    IndirectCuller(const IndirectCuller&) = delete;
+    IndirectCuller& operator=(const IndirectCuller&) = delete;
+    IndirectCuller(IndirectCuller&&) noexcept = default;
+    IndirectCuller& operator=(IndirectCuller&&) noexcept = default;
+
+    // Whether the pipeline has been created, i.e. the culler isn't default constructed
+    bool IsCreated() const noexcept { return device != nullptr; }
+
+    // Start recording frame. Frees the descriptor sets of the frame last recorded with this index, which must have finished executing.
+    void BeginFrame(uint32_t frame) noexcept;
+
+    /**
+     * @brief Record the culling of instances. The commands must run before the draws that read the results, with Barrier() between them.
+     *
+     * @param command_buffer The command buffer to record to. It must not be inside a render pass.
+     * @param buffers The ring buffer of the frame, which the runs, commands and visible instances are written to. It needs storage and
+     *        indirect buffer usage.
+     * @param instances The buffer of the instances (Instance3D). It needs storage buffer usage.
+     * @param instance_count The number of instances in the buffer
+     * @param runs The runs, sorted by their first instance and not overlapping. Instances outside every run are dropped.
+     * @param frustum The frustum to cull against, in the space the instance transforms transform to
+     * @return Where the commands, their draw counts and the visible instances are written
+     *
+     * @throw std::runtime_error with error information on failure, or if more than MAX_JOBS_PER_FRAME jobs were recorded in one frame
+     */
+    Job Cull(VkCommandBuffer command_buffer, RingBuffer& buffers, VkBuffer instances, uint32_t instance_count, std::span<const Run> runs,
+        const Frustum& frustum);
+
+    // Make the results of every Cull recorded before it visible to the indirect draws and vertex input recorded after it
+    static void Barrier(VkCommandBuffer command_buffer) noexcept;
+
+private:
+    VkDevice device;
+    VkDeviceSize alignment;
+    uint32_t current_frame;
+    DescriptorSetLayout layout;
+    std::array<DescriptorPool, MAX_FRAMES_IN_FLIGHT> pools;
+    ComputePipeline pipeline;
+};
+}
+
+#endif
\ No newline at end of file
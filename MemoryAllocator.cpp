@@ -0,0 +1,342 @@
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include "MemoryAllocator.h"
+#include "VkResultString.h"
+
+namespace VKKit {
+static constexpr VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+MemoryAllocator::MemoryAllocator(VkPhysicalDevice physical_device, VkDevice device, bool memory_budget, VkDeviceSize block_size) :
+    physical_device{ physical_device }, device{ device }, memory_budget{ memory_budget }, block_size{ block_size }, category_usage{},
+    heap_bytes{}, heap_peaks{}, dedicated_count{ 0 }, allocation_count{ 0 }, dedicated_bytes{ 0 }, used_bytes{ 0 }
+{
+    vkGetPhysicalDeviceMemoryProperties(physical_device, &memory_properties);
+    policy = MemoryPolicy(memory_properties);
+}
+
+MemoryAllocator::~MemoryAllocator()
+{
+    // Every resource should have been destroyed by now, so only the blocks themselves are left to free
+    for (auto& type_blocks : blocks) {
+        for (auto& block : type_blocks) {
+            if (block.memory) vkFreeMemory(device, block.memory, nullptr);
+        }
+    }
+}
+
+Allocation MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, MemoryCategory category,
+    ResourceTiling tiling)
+{
+    return AllocateMemoryType(requirements, FindMemoryType(requirements.memoryTypeBits, properties), category, tiling);
+}
+
+Allocation MemoryAllocator::Allocate(const VkMemoryRequirements& requirements, MemoryUsage usage, MemoryCategory category, ResourceTiling tiling)
+{
+    const uint32_t memory_type = policy.FindMemoryType(requirements.memoryTypeBits, usage);
+    if (memory_type == std::numeric_limits<uint32_t>::max()) throw std::runtime_error("Failed to find suitable memory type");
+
+    return AllocateMemoryType(requirements, memory_type, category, tiling);
+}
+
+Allocation MemoryAllocator::AllocateMemoryType(const VkMemoryRequirements& requirements, uint32_t memory_type, MemoryCategory category,
+    ResourceTiling tiling)
+{
+    const VkDeviceSize type_block_size = GetBlockSize(memory_type);
+
+    std::scoped_lock lock(mutex);
+
+    // Big resources would waste most of a block, give them their own memory
+    if (requirements.size > type_block_size / 2) {
+        Allocation allocation = {
+            .offset = 0,
+            .size = requirements.size,
+            .mapped = nullptr,
+            .memory_type = memory_type,
+            .block = DEDICATED_BLOCK,
+            .category = category,
+            .tiling = tiling
+        };
+        allocation.memory = AllocateDeviceMemory(requirements.size, memory_type, &allocation.mapped);
+
+        ++dedicated_count;
+        ++allocation_count;
+        dedicated_bytes += requirements.size;
+        used_bytes += requirements.size;
+        Track(category, requirements.size);
+
+        return allocation;
+    }
+
+    auto& type_blocks = GetPool(memory_type, tiling);
+    VkDeviceSize offset = 0;
+    uint32_t block_index = DEDICATED_BLOCK;
+
+    for (uint32_t i = 0; i < type_blocks.size(); ++i) {
+        if (type_blocks[i].memory && AllocateFromBlock(type_blocks[i], requirements.size, requirements.alignment, offset)) {
+            block_index = i;
+            break;
+        }
+    }
+
+    if (block_index == DEDICATED_BLOCK) {
+        // No block has room, create a new one (reusing the slot of a block that was released earlier, if any)
+        const auto free_slot = std::find_if(type_blocks.begin(), type_blocks.end(), [](const Block& b) { return b.memory == nullptr; });
+        block_index = static_cast<uint32_t>(free_slot - type_blocks.begin());
+        if (free_slot == type_blocks.end()) type_blocks.emplace_back();
+
+        Block& block = type_blocks[block_index];
+        block.size = type_block_size;
+        block.memory = AllocateDeviceMemory(type_block_size, memory_type, &block.mapped);
+        block.free_ranges = { FreeRange{ 0, type_block_size } };
+        block.allocations = 0;
+
+        const bool allocated = AllocateFromBlock(block, requirements.size, requirements.alignment, offset);
+        (void)allocated;
+        assert(allocated);
+    }
+
+    Block& block = type_blocks[block_index];
+    ++block.allocations;
+    ++allocation_count;
+    used_bytes += requirements.size;
+    Track(category, requirements.size);
+
+    return Allocation {
+        .memory = block.memory,
+        .offset = offset,
+        .size = requirements.size,
+        .mapped = block.mapped ? static_cast<char*>(block.mapped) + offset : nullptr,
+        .memory_type = memory_type,
+        .block = block_index,
+        .category = category,
+        .tiling = tiling
+    };
+}
+
+void MemoryAllocator::Free(const Allocation& allocation) noexcept
+{
+    if (!allocation.memory) return;
+
+    std::scoped_lock lock(mutex);
+
+    --allocation_count;
+    used_bytes -= allocation.size;
+    Untrack(allocation.category, allocation.size);
+
+    if (allocation.block == DEDICATED_BLOCK) {
+        --dedicated_count;
+        dedicated_bytes -= allocation.size;
+        FreeDeviceMemory(allocation.memory, allocation.size, allocation.memory_type);
+        return;
+    }
+
+    auto& type_blocks = GetPool(allocation.memory_type, allocation.tiling);
+    Block& block = type_blocks[allocation.block];
+    FreeToBlock(block, allocation.offset, allocation.size);
+
+    if (--block.allocations == 0) {
+        // Keep one empty block per memory type around, so that a resource being created and destroyed every frame doesn't
+        // allocate and free a whole block every time
+        const bool other_empty_block = std::any_of(type_blocks.begin(), type_blocks.end(), [&block](const Block& b) {
+            return &b != &block && b.memory && b.allocations == 0;
+        });
+
+        if (other_empty_block) {
+            FreeDeviceMemory(block.memory, block.size, allocation.memory_type);
+            block = Block{};
+        }
+    }
+}
+
+uint32_t MemoryAllocator::FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+        if ((type_filter & (1 << i)) && (memory_properties.memoryTypes[i].propertyFlags & properties) == properties)
+            return i;
+    }
+
+    throw std::runtime_error("Failed to find suitable memory type");
+}
+
+MemoryStatistics MemoryAllocator::GetStatistics() const
+{
+    std::scoped_lock lock(mutex);
+
+    MemoryStatistics statistics = {
+        .block_count = 0,
+        .dedicated_count = dedicated_count,
+        .allocation_count = allocation_count,
+        .reserved_bytes = dedicated_bytes,
+        .used_bytes = used_bytes
+    };
+
+    for (const auto& type_blocks : blocks) {
+        for (const auto& block : type_blocks) {
+            if (!block.memory) continue;
+            ++statistics.block_count;
+            statistics.reserved_bytes += block.size;
+        }
+    }
+
+    return statistics;
+}
+
+MemoryReport MemoryAllocator::GetReport() const
+{
+    MemoryReport report{};
+    report.heaps.resize(memory_properties.memoryHeapCount);
+    report.budget_available = memory_budget;
+
+    VkPhysicalDeviceMemoryBudgetPropertiesEXT budget = {
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT
+    };
+
+    if (memory_budget) {
+        VkPhysicalDeviceMemoryProperties2 properties = {
+            .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+            .pNext = &budget
+        };
+        vkGetPhysicalDeviceMemoryProperties2(physical_device, &properties);
+    }
+
+    std::scoped_lock lock(mutex);
+
+    report.categories = category_usage;
+
+    for (uint32_t i = 0; i < memory_properties.memoryHeapCount; ++i) {
+        const VkMemoryHeap& heap = memory_properties.memoryHeaps[i];
+        MemoryHeapUsage& usage = report.heaps[i];
+
+        usage.size = heap.size;
+        usage.device_local = (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+        usage.allocated = heap_bytes[i];
+        usage.peak_allocated = heap_peaks[i];
+
+        if (memory_budget) {
+            usage.budget = budget.heapBudget[i];
+            usage.usage = budget.heapUsage[i];
+        }
+        else {
+            // Without the extension, assume 80% of the heap is available. The OS and other processes need the rest.
+            usage.budget = heap.size / 10 * 8;
+            usage.usage = heap_bytes[i];
+        }
+    }
+
+    return report;
+}
+
+VkDeviceSize MemoryAllocator::GetBlockSize(uint32_t memory_type) const noexcept
+{
+    // Small heaps (such as the 256MB host visible device local heap without ReBAR) get smaller blocks so a few of them don't fill up the heap
+    const VkDeviceSize heap_size = memory_properties.memoryHeaps[memory_properties.memoryTypes[memory_type].heapIndex].size;
+    return std::min(block_size, std::max<VkDeviceSize>(heap_size / 8, 1));
+}
+
+VkDeviceMemory MemoryAllocator::AllocateDeviceMemory(VkDeviceSize size, uint32_t memory_type, void** mapped)
+{
+    const VkMemoryAllocateInfo alloc_info = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+        .allocationSize = size,
+        .memoryTypeIndex = memory_type
+    };
+
+    VkDeviceMemory memory;
+    const auto alloc_result = vkAllocateMemory(device, &alloc_info, nullptr, &memory);
+    if (alloc_result != VK_SUCCESS) ThrowError("Failed to allocate device memory.", alloc_result);
+
+    const uint32_t heap = memory_properties.memoryTypes[memory_type].heapIndex;
+    heap_bytes[heap] += size;
+    heap_peaks[heap] = std::max(heap_peaks[heap], heap_bytes[heap]);
+
+    *mapped = nullptr;
+    if (memory_properties.memoryTypes[memory_type].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+        const auto map_result = vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, mapped);
+        if (map_result != VK_SUCCESS) {
+            FreeDeviceMemory(memory, size, memory_type);
+            ThrowError("Failed to map device memory.", map_result);
+        }
+    }
+
+    return memory;
+}
+
+void MemoryAllocator::FreeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memory_type) noexcept
+{
+    vkFreeMemory(device, memory, nullptr); // Implicitly unmaps the memory
+    heap_bytes[memory_properties.memoryTypes[memory_type].heapIndex] -= size;
+}
+
+std::vector<MemoryAllocator::Block>& MemoryAllocator::GetPool(uint32_t memory_type, ResourceTiling tiling) noexcept
+{
+    return blocks[tiling == ResourceTiling::OPTIMAL ? VK_MAX_MEMORY_TYPES + memory_type : memory_type];
+}
+
+void MemoryAllocator::Track(MemoryCategory category, VkDeviceSize size) noexcept
+{
+    MemoryCategoryUsage& usage = category_usage[static_cast<size_t>(category)];
+    usage.current += size;
+    usage.peak = std::max(usage.peak, usage.current);
+    ++usage.allocation_count;
+}
+
+void MemoryAllocator::Untrack(MemoryCategory category, VkDeviceSize size) noexcept
+{
+    MemoryCategoryUsage& usage = category_usage[static_cast<size_t>(category)];
+    usage.current -= size;
+    --usage.allocation_count;
+}
+
+// First fit search through the block's free ranges. On success, writes the aligned offset of the allocation to offset.
+bool MemoryAllocator::AllocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset)
+{
+    for (size_t i = 0; i < block.free_ranges.size(); ++i) {
+        const FreeRange range = block.free_ranges[i];
+        const VkDeviceSize aligned = AlignUp(range.offset, std::max<VkDeviceSize>(alignment, 1));
+
+        if (aligned + size > range.offset + range.size) continue;
+
+        const FreeRange before = { range.offset, aligned - range.offset };
+        const FreeRange after = { aligned + size, range.offset + range.size - aligned - size };
+
+        // The padding in front of the allocation stays free, so a smaller allocation can use it later
+        if (before.size != 0 && after.size != 0) {
+            block.free_ranges[i] = before;
+            block.free_ranges.insert(block.free_ranges.begin() + i + 1, after);
+        }
+        else if (before.size != 0) block.free_ranges[i] = before;
+        else if (after.size != 0) block.free_ranges[i] = after;
+        else block.free_ranges.erase(block.free_ranges.begin() + i);
+
+        offset = aligned;
+        return true;
+    }
+
+    return false;
+}
+
+// Give a range back to the block, merging it with the free ranges on either side of it
+void MemoryAllocator::FreeToBlock(Block& block, VkDeviceSize offset, VkDeviceSize size)
+{
+    auto& ranges = block.free_ranges;
+    const auto next = std::lower_bound(ranges.begin(), ranges.end(), offset, [](const FreeRange& r, VkDeviceSize o) { return r.offset < o; });
+
+    const bool merge_prev = next != ranges.begin() && std::prev(next)->offset + std::prev(next)->size == offset;
+    const bool merge_next = next != ranges.end() && offset + size == next->offset;
+
+    if (merge_prev && merge_next) {
+        std::prev(next)->size += size + next->size;
+        ranges.erase(next);
+    }
+    else if (merge_prev) std::prev(next)->size += size;
+    else if (merge_next) {
+        next->offset = offset;
+        next->size += size;
+    }
+    else ranges.insert(next, FreeRange{ offset, size });
+}
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+#ifndef MEMORYALLOCATOR_H
+#define MEMORYALLOCATOR_H
+
+#include <array>
+#include <vector>
+#include <mutex>
+#include <limits>
+#include "vulkan/vulkan.h"
+#include "MemoryPolicy.h"
+#include "MemoryReport.h"
+
+namespace VKKit {
+// The layout a resource keeps in memory. Buffers and linear images are LINEAR, optimally tiled images are OPTIMAL. The two are sub-allocated
+// from separate blocks, so they never end up on the same bufferImageGranularity page.
+enum class ResourceTiling { LINEAR, OPTIMAL };
+
+// A range of device memory handed out by a MemoryAllocator
+struct Allocation {
+    VkDeviceMemory memory;
+    VkDeviceSize offset;
+    VkDeviceSize size;
+    void* mapped; // Host address of the first byte of the allocation, nullptr if the memory is not host visible
+    uint32_t memory_type;
+    uint32_t block; // Index of the block the allocation was carved out of, or MemoryAllocator::DEDICATED_BLOCK
+    MemoryCategory category;
+    ResourceTiling tiling;
+};
+
+// A snapshot of how much device memory a MemoryAllocator is holding
+struct MemoryStatistics {
+    size_t block_count;          // Number of large blocks that are currently allocated
+    size_t dedicated_count;      // Number of requests that were too big for a block and got their own VkDeviceMemory
+    size_t allocation_count;     // Number of live sub-allocations and dedicated allocations
+    VkDeviceSize reserved_bytes; // Bytes allocated from the driver (blocks + dedicated allocations)
+    VkDeviceSize used_bytes;     // Bytes handed out to resources
+};
+
+// Sub-allocates device memory out of large per-memory-type blocks, so that creating a resource doesn't need a vkAllocateMemory call.
+// Host visible blocks are persistently mapped. All member functions are thread safe.
+class MemoryAllocator {
+public:
+    static constexpr VkDeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+    static constexpr uint32_t DEDICATED_BLOCK = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief Construct a memory allocator. No memory is allocated until the first call to Allocate().
+     *
+     * @param physical_device The physical device whose memory types will be used
+     * @param device The logical device which will own the memory
+     * @param memory_budget Was VK_EXT_memory_budget enabled on the device. If it was, GetReport() queries the heap budgets from the driver.
+     * @param block_size The size of each memory block. Requests larger than half a block get a dedicated allocation.
+     */
+    MemoryAllocator(VkPhysicalDevice physical_device, VkDevice device, bool memory_budget = false, VkDeviceSize block_size = DEFAULT_BLOCK_SIZE);
+    ~MemoryAllocator();
+
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+    MemoryAllocator(MemoryAllocator&&) = delete;
+    MemoryAllocator& operator=(MemoryAllocator&&) = delete;
+
+    /**
+     * @brief Allocate memory for a resource
+     *
+     * @param requirements The memory requirements of the resource (from vkGet*MemoryRequirements)
+     * @param properties The memory properties the allocation must have
+     * @param category What the memory will be used for, for accounting purposes
+     * @param tiling Whether the resource is a buffer/linear image or an optimally tiled image
+     * @return The allocation. Bind the resource at allocation.offset inside allocation.memory.
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    Allocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, MemoryCategory category = MemoryCategory::OTHER,
+        ResourceTiling tiling = ResourceTiling::LINEAR);
+
+    /**
+     * @brief Allocate memory for a resource, letting the memory policy pick the memory type
+     *
+     * @param requirements The memory requirements of the resource (from vkGet*MemoryRequirements)
+     * @param usage How the memory will be accessed
+     * @param category What the memory will be used for, for accounting purposes
+     * @param tiling Whether the resource is a buffer/linear image or an optimally tiled image
+     * @return The allocation. Bind the resource at allocation.offset inside allocation.memory. allocation.mapped is not nullptr if the
+     *         memory type that was picked is host visible.
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    Allocation Allocate(const VkMemoryRequirements& requirements, MemoryUsage usage, MemoryCategory category = MemoryCategory::OTHER,
+        ResourceTiling tiling = ResourceTiling::LINEAR);
+
+    /**
+     * @brief Return an allocation to the allocator. The resource bound to it must already be destroyed.
+     * @param allocation An allocation previously returned by Allocate()
+     */
+    void Free(const Allocation& allocation) noexcept;
+
+    /**
+     * @brief Find the index of the first memory type that is allowed by type_filter and has all the requested properties
+     * @throw std::runtime_error if no memory type matches
+     */
+    uint32_t FindMemoryType(uint32_t type_filter, VkMemoryPropertyFlags properties) const;
+
+    const VkPhysicalDeviceMemoryProperties& GetMemoryProperties() const noexcept { return memory_properties; }
+    const MemoryPolicy& GetPolicy() const noexcept { return policy; }
+
+    MemoryStatistics GetStatistics() const;
+
+    /**
+     * @brief Get the current and peak usage of every memory category and heap. Heap budgets come from VK_EXT_memory_budget if it is
+     *        enabled, otherwise they are estimated.
+     */
+    MemoryReport GetReport() const;
+
+private:
+    // A free range inside a block. Free ranges are kept sorted by offset and are never adjacent to each other.
+    struct FreeRange {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+    };
+
+    struct Block {
+        VkDeviceMemory memory;
+        VkDeviceSize size;
+        void* mapped;
+        std::vector<FreeRange> free_ranges;
+        size_t allocations;
+    };
+
+    VkPhysicalDevice physical_device;
+    VkDevice device;
+    bool memory_budget;
+    VkDeviceSize block_size;
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    MemoryPolicy policy;
+    std::array<std::vector<Block>, VK_MAX_MEMORY_TYPES * 2> blocks; // Linear pools first, then optimal pools
+
+    std::array<MemoryCategoryUsage, MEMORY_CATEGORY_COUNT> category_usage;
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heap_bytes;
+    std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> heap_peaks;
+
+    size_t dedicated_count;
+    size_t allocation_count;
+    VkDeviceSize dedicated_bytes;
+    VkDeviceSize used_bytes;
+
+    mutable std::mutex mutex;
+
+    Allocation AllocateMemoryType(const VkMemoryRequirements& requirements, uint32_t memory_type, MemoryCategory category, ResourceTiling tiling);
+    std::vector<Block>& GetPool(uint32_t memory_type, ResourceTiling tiling) noexcept;
+    VkDeviceSize GetBlockSize(uint32_t memory_type) const noexcept;
+    VkDeviceMemory AllocateDeviceMemory(VkDeviceSize size, uint32_t memory_type, void** mapped);
+    void FreeDeviceMemory(VkDeviceMemory memory, VkDeviceSize size, uint32_t memory_type) noexcept;
+    void Track(MemoryCategory category, VkDeviceSize size) noexcept;
+    void Untrack(MemoryCategory category, VkDeviceSize size) noexcept;
+    bool AllocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, VkDeviceSize& offset);
+    void FreeToBlock(Block& block, VkDeviceSize offset, VkDeviceSize size);
+};
+
+// Owns an allocation and returns it to its allocator when destroyed. Used by resources that don't manage their memory themselves.
+class ScopedAllocation {
+public:
+    ScopedAllocation() noexcept : allocator{ nullptr }, allocation{} {}
+    ScopedAllocation(MemoryAllocator& allocator, const Allocation& allocation) noexcept : allocator{ &allocator }, allocation{ allocation } {}
+
+    ~ScopedAllocation()
+    {
+        if (allocator) allocator->Free(allocation);
+    }
+
+    ScopedAllocation(const ScopedAllocation&) = delete;
+    ScopedAllocation& operator=(const ScopedAllocation&) = delete;
+    ScopedAllocation(ScopedAllocation&& a) noexcept : allocator{ a.allocator }, allocation{ a.allocation }
+    {
+        a.allocator = nullptr;
+    }
+    ScopedAllocation& operator=(ScopedAllocation&& a) noexcept
+    {
+        if (allocator) allocator->Free(allocation);
+
+        allocator = a.allocator;
+        allocation = a.allocation;
+        a.allocator = nullptr;
+
+        return *this;
+    }
+
+    const Allocation& Get() const noexcept { return allocation; }
+
+private:
+    MemoryAllocator* allocator;
+    Allocation allocation;
+};
+}
+
+#endif
\ No newline at end of file
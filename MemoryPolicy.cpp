@@ -0,0 +1,65 @@
+#include <limits>
+#include <algorithm>
+#include "MemoryPolicy.h"
+
+namespace VKKit {
+static constexpr VkMemoryPropertyFlags HOST_VISIBLE_COHERENT = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+MemoryPolicy::MemoryPolicy() noexcept : memory_properties{}, preferences{}, unified_memory{ false }
+{}
+
+MemoryPolicy::MemoryPolicy(const VkPhysicalDeviceMemoryProperties& memory_properties) noexcept :
+    memory_properties{ memory_properties }, preferences{}, unified_memory{ false }
+{
+    // Without resizable BAR a discrete GPU only exposes a small (usually 256MB) window of its memory as host visible. That window is fine
+    // for per-frame data but too small to hold every static resource, so it only counts as unified memory if it covers the biggest
+    // device local heap.
+    VkDeviceSize largest_device_heap = 0, largest_mappable_device_heap = 0;
+    for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+        const VkMemoryType& type = memory_properties.memoryTypes[i];
+        if (!(type.propertyFlags & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT)) continue;
+
+        const VkDeviceSize heap_size = memory_properties.memoryHeaps[type.heapIndex].size;
+        largest_device_heap = std::max(largest_device_heap, heap_size);
+        if ((type.propertyFlags & HOST_VISIBLE_COHERENT) == HOST_VISIBLE_COHERENT)
+            largest_mappable_device_heap = std::max(largest_mappable_device_heap, heap_size);
+    }
+    unified_memory = largest_device_heap != 0 && largest_mappable_device_heap == largest_device_heap;
+
+    auto& static_preferences = preferences[static_cast<size_t>(MemoryUsage::STATIC)];
+    if (unified_memory) static_preferences.Add(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | HOST_VISIBLE_COHERENT, 0);
+    else static_preferences.Add(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT);
+    static_preferences.Add(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 0);
+    static_preferences.Add(0, 0);
+
+    preferences[static_cast<size_t>(MemoryUsage::DYNAMIC)].Add(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | HOST_VISIBLE_COHERENT, 0);
+    preferences[static_cast<size_t>(MemoryUsage::DYNAMIC)].Add(HOST_VISIBLE_COHERENT, 0);
+
+    // Staging memory shouldn't take up the host visible part of device memory, which is better used for dynamic data
+    preferences[static_cast<size_t>(MemoryUsage::UPLOAD)].Add(HOST_VISIBLE_COHERENT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    preferences[static_cast<size_t>(MemoryUsage::UPLOAD)].Add(HOST_VISIBLE_COHERENT, 0);
+
+    // Reading uncached memory from the CPU is very slow
+    preferences[static_cast<size_t>(MemoryUsage::READBACK)].Add(HOST_VISIBLE_COHERENT | VK_MEMORY_PROPERTY_HOST_CACHED_BIT, 0);
+    preferences[static_cast<size_t>(MemoryUsage::READBACK)].Add(HOST_VISIBLE_COHERENT, 0);
+}
+
+uint32_t MemoryPolicy::FindMemoryType(uint32_t type_filter, MemoryUsage usage) const noexcept
+{
+    const PreferenceList& usage_preferences = preferences[static_cast<size_t>(usage)];
+
+    for (const bool allow_avoided : { false, true }) {
+        for (size_t j = 0; j < usage_preferences.count; ++j) {
+            const Preference& p = usage_preferences.entries[j];
+            for (uint32_t i = 0; i < memory_properties.memoryTypeCount; ++i) {
+                const VkMemoryPropertyFlags flags = memory_properties.memoryTypes[i].propertyFlags;
+                if (!(type_filter & (1u << i)) || (flags & p.required) != p.required) continue;
+                if (!allow_avoided && (flags & p.avoided)) continue;
+                return i;
+            }
+        }
+    }
+
+    return std::numeric_limits<uint32_t>::max();
+}
+}
\ No newline at end of file
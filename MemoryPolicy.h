@@ -0,0 +1,60 @@
+#ifndef MEMORYPOLICY_H
+#define MEMORYPOLICY_H
+
+#include "vulkan/vulkan.h"
+
+namespace VKKit {
+// How a resource's memory will be accessed. Used to pick the best memory type for it.
+enum class MemoryUsage {
+    STATIC,   // Written once (or rarely) and read by the GPU many times, e.g. meshes and textures
+    DYNAMIC,  // Rewritten by the CPU every frame and read by the GPU, e.g. uniform buffers and streamed geometry
+    UPLOAD,   // Staging memory the CPU writes and the GPU copies from
+    READBACK  // Written by the GPU and read by the CPU
+};
+
+// Picks memory types for each MemoryUsage. The choices are made once from the physical device's memory properties, so looking up a memory
+// type is cheap. On devices where device local memory is also host visible (integrated GPUs, CPU drivers, discrete GPUs with resizable
+// BAR) static resources are put in memory that the CPU can write to directly, so they don't need a staging copy.
+class MemoryPolicy {
+public:
+    MemoryPolicy() noexcept;
+    MemoryPolicy(const VkPhysicalDeviceMemoryProperties& memory_properties) noexcept;
+
+    /**
+     * @brief Find the best memory type for a resource
+     * @param type_filter The memoryTypeBits of the resource's memory requirements
+     * @param usage How the memory will be used
+     * @return The index of the memory type, or UINT32_MAX if no memory type can be used
+     */
+    uint32_t FindMemoryType(uint32_t type_filter, MemoryUsage usage) const noexcept;
+
+    // Is the whole of device local memory host visible? If so, static resources can be written directly instead of through staging buffers.
+    bool IsUnifiedMemory() const noexcept { return unified_memory; }
+
+    VkMemoryPropertyFlags GetPropertyFlags(uint32_t memory_type) const noexcept { return memory_properties.memoryTypes[memory_type].propertyFlags; }
+
+private:
+    // The memory types to try for a usage, most preferred first. A memory type must have all of the required flags and, for the
+    // first pass over the list, none of the avoided ones.
+    struct Preference {
+        VkMemoryPropertyFlags required;
+        VkMemoryPropertyFlags avoided;
+    };
+
+    static constexpr size_t MAX_PREFERENCES = 3;
+    static constexpr size_t USAGE_COUNT = 4;
+
+    struct PreferenceList {
+        Preference entries[MAX_PREFERENCES];
+        size_t count;
+
+        void Add(VkMemoryPropertyFlags required, VkMemoryPropertyFlags avoided) noexcept { entries[count++] = { required, avoided }; }
+    };
+
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    PreferenceList preferences[USAGE_COUNT];
+    bool unified_memory;
+};
+}
+
+#endif
\ No newline at end of file
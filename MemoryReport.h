@@ -0,0 +1,53 @@
+#ifndef MEMORYREPORT_H
+#define MEMORYREPORT_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace VKKit {
+// What a piece of device memory is used for. Every allocation is tagged with one of these, so usage can be broken down by category.
+enum class MemoryCategory { GEOMETRY, TEXTURE, FONT, ATTACHMENT, STAGING, UNIFORM, OTHER, COUNT };
+
+constexpr size_t MEMORY_CATEGORY_COUNT = static_cast<size_t>(MemoryCategory::COUNT);
+
+constexpr const char* MemoryCategoryName(MemoryCategory category) noexcept
+{
+    constexpr std::array<const char*, MEMORY_CATEGORY_COUNT> names = {
+        "Geometry", "Texture", "Font", "Attachment", "Staging", "Uniform", "Other"
+    };
+    return category < MemoryCategory::COUNT ? names[static_cast<size_t>(category)] : "Unknown";
+}
+
+// How many bytes of resources of one category are alive, and the most that were alive at once
+struct MemoryCategoryUsage {
+    uint64_t current;
+    uint64_t peak;
+    size_t allocation_count;
+};
+
+// Usage of a single memory heap
+struct MemoryHeapUsage {
+    uint64_t size;           // Total size of the heap
+    bool device_local;       // Is the heap in video memory
+    uint64_t allocated;      // Bytes VKKit has allocated from the heap (blocks + dedicated allocations)
+    uint64_t peak_allocated; // The most bytes VKKit had allocated from the heap at once
+    uint64_t budget;         // How much the process can allocate from the heap before allocations start failing or hurting performance
+    uint64_t usage;          // How much the whole process is using the heap, including memory not allocated by VKKit
+};
+
+// A snapshot of device memory usage
+struct MemoryReport {
+    std::array<MemoryCategoryUsage, MEMORY_CATEGORY_COUNT> categories;
+    std::vector<MemoryHeapUsage> heaps;
+
+    // Did the driver report budget and usage (VK_EXT_memory_budget). If not, budget is an estimate of 80% of the heap size and usage
+    // only counts VKKit's own allocations.
+    bool budget_available;
+
+    const MemoryCategoryUsage& operator[](MemoryCategory category) const noexcept { return categories[static_cast<size_t>(category)]; }
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include <cstring>
+#include "MeshBuffer.h"
+#include "Device.h"
+#include "UploadQueue.h"
+
+namespace VKKit {
+MeshBuffer::MeshBuffer() : index_offset{ 0 }, index_count{ 0 }
+{}
+
+MeshBuffer::MeshBuffer(const Device& device, std::span<const float> vertices, std::span<const uint32_t> indices) :
+    index_offset{ vertices.size_bytes() }, index_count{ static_cast<uint32_t>(indices.size()) }
+{
+    // The vertices are floats, so the indices that follow them are already aligned to the index size
+    const VkDeviceSize size = vertices.size_bytes() + indices.size_bytes();
+    if (size == 0) return;
+
+    buffer = Buffer(device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        MemoryUsage::STATIC);
+
+    if (void* mapped = buffer.GetMapped()) {
+        memcpy(mapped, vertices.data(), vertices.size_bytes());
+        memcpy(static_cast<char*>(mapped) + index_offset, indices.data(), indices.size_bytes());
+        return;
+    }
+
+    UploadQueue& upload_queue = device.GetUploadQueue();
+    Buffer staging = upload_queue.AcquireStaging(size);
+    memcpy(staging.GetMapped(), vertices.data(), vertices.size_bytes());
+    memcpy(static_cast<char*>(staging.GetMapped()) + index_offset, indices.data(), indices.size_bytes());
+
+    const VkBuffer src = staging.GetBuffer(), dst = buffer.GetBuffer();
+    upload_queue.Record([&](VkCommandBuffer command_buffer) {
+        const VkBufferCopy region = {
+            .srcOffset = 0,
+            .dstOffset = 0,
+            .size = size
+        };
+        vkCmdCopyBuffer(command_buffer, src, dst, 1, &region);
+    }, std::move(staging));
+    upload_queue.TransferOwnership(buffer);
+}
+
+void MeshBuffer::Bind(BindCache& binds) const noexcept
+{
+    binds.BindVertexBuffer(0, buffer.GetBuffer(), 0);
+    binds.BindIndexBuffer(buffer.GetBuffer(), index_offset, VK_INDEX_TYPE_UINT32);
+}
+}
\ No newline at end of file
@@ -0,0 +1,49 @@
+#ifndef MESHBUFFER_H
+#define MESHBUFFER_H
+
+#include <span>
+#include "vulkan/vulkan.h"
+#include "Buffer.h"
+#include "BindCache.h"
+
+namespace VKKit {
+class Device;
+
+// The vertices and indices of a static mesh packed into one buffer, so a mesh takes a single allocation and a single upload. The vertices
+// are at the start of the buffer and the indices follow them.
+class MeshBuffer {
+public:
+    MeshBuffer();
+
+    /**
+     * @brief Create a mesh buffer. If its memory is host visible the data is written directly, otherwise it is uploaded through the
+     *        device's UploadQueue in one copy.
+     *
+     * @param device The logical device used
+     * @param vertices The vertex data
+     * @param indices The indices into the vertices
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    MeshBuffer(const Device& device, std::span<const float> vertices, std::span<const uint32_t> indices);
+
+    MeshBuffer(const MeshBuffer&) = delete;
+    MeshBuffer& operator=(const MeshBuffer&) = delete;
+    MeshBuffer(MeshBuffer&&) noexcept = default;
+    MeshBuffer& operator=(MeshBuffer&&) noexcept = default;
+
+    // Bind the buffer as vertex buffer 0 and as the index buffer
+    void Bind(BindCache& binds) const noexcept;
+
+    VkBuffer GetBuffer() const noexcept { return buffer.GetBuffer(); }
+    VkDeviceSize GetIndexOffset() const noexcept { return index_offset; }
+    uint32_t GetIndexCount() const noexcept { return index_count; }
+
+private:
+    Buffer buffer;
+    VkDeviceSize index_offset;
+    uint32_t index_count;
+};
+}
+
+#endif
\ No newline at end of file
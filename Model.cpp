@@ -54,9 +54,28 @@
 namespace VKKit {
 Model::Model(std::string_view filepath)
 {
-    (void)filepath;
-    // Assimp::Importer importer;
-    // const aiScene* scene = importer.ReadFile(filepath.data(), aiProcess_Triangulate | aiProcess_FlipUVs);
+    LoadModel(filepath);
+
+    if (!meshes.empty() && !meshes.front().vertices.empty()) bounds_min = bounds_max = meshes.front().vertices.front().pos;
+
+    // Flatten the meshes into the layout of the 3D texture pipeline, so the whole model can be drawn with one draw call
+    for (const Mesh& mesh : meshes) {
+        const auto base = static_cast<uint32_t>(vertices.size() / 5);
+
+        for (const ModelVertex& v : mesh.vertices) {
+            vertices.insert(vertices.end(), { v.pos.x, v.pos.y, v.pos.z, v.tex_coords.x, v.tex_coords.y });
+            bounds_min = glm::min(bounds_min, v.pos);
+            bounds_max = glm::max(bounds_max, v.pos);
+        }
+
+        for (const uint32_t index : mesh.indices) indices.push_back(base + index);
+    }
+}
+
+const MeshBuffer& Model::GetMeshBuffer(const Device& device) const
+{
+    if (!mesh_buffer.GetBuffer() && !indices.empty()) mesh_buffer = MeshBuffer(device, vertices, indices);
+    return mesh_buffer;
 }
 
 void Model::LoadModel(std::string_view path)
@@ -100,11 +119,11 @@ Mesh Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
                 mesh->mVertices[i].y,
                 mesh->mVertices[i].z
             ),
-            .normal = glm::vec3(
+            .normal = mesh->HasNormals() ? glm::vec3(
                 mesh->mNormals[i].x,
                 mesh->mNormals[i].y,
                 mesh->mNormals[i].z
-            ),
+            ) : glm::vec3(0.0f, 0.0f, 0.0f),
             .tex_coords = mesh->mTextureCoords[0] ? glm::vec2(
                 mesh->mTextureCoords[0][i].x,
                 mesh->mTextureCoords[0][i].y
@@ -118,7 +137,7 @@ Mesh Model::ProcessMesh(aiMesh* mesh, const aiScene* scene)
         aiFace face = mesh->mFaces[i];
 
         for (size_t j = 0; j < face.mNumIndices; ++j) {
-            indices.push_back(face.mIndices[j]);
+            result_mesh.indices.push_back(face.mIndices[j]);
         }
     }
 
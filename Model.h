@@ -6,12 +6,15 @@
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "Buffer.h"
+#include "MeshBuffer.h"
 // #include "RenderData.h"
 #include "assimp/Importer.hpp"
 #include "assimp/scene.h"
 #include "assimp/postprocess.h"
 
 namespace VKKit {
+class Device;
+
 struct ModelVertex {
     glm::vec3 pos;
     glm::vec3 normal;
@@ -31,6 +34,16 @@ public:
     const std::vector<float>& GetVertices() const noexcept { return vertices; }
     const std::vector<uint32_t>& GetIndices() const noexcept { return indices; }
 
+    // The corners of the box around every vertex of the model
+    glm::vec3 GetBoundsMin() const noexcept { return bounds_min; }
+    glm::vec3 GetBoundsMax() const noexcept { return bounds_max; }
+
+    /**
+     * @brief Get the model's geometry on the GPU. It is uploaded the first time this is called, to the device passed in then.
+     * @throw std::runtime_error with error information if the upload fails
+     */
+    const MeshBuffer& GetMeshBuffer(const Device& device) const;
+
 private:
     std::vector<Mesh> meshes;
     std::string directory;
@@ -39,8 +52,10 @@ private:
     void ProcessNode(aiNode* node, const aiScene* scene);
     Mesh ProcessMesh(aiMesh* mesh, const aiScene* scene);
 
-    std::vector<float> vertices;
+    std::vector<float> vertices; // Position and texture coordinates of every vertex of every mesh
     std::vector<uint32_t> indices;
+    glm::vec3 bounds_min{ 0.0f }, bounds_max{ 0.0f };
+    mutable MeshBuffer mesh_buffer;
 };
 }
 
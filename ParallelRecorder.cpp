@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <utility>
+#include "ParallelRecorder.h"
+#include "VkResultString.h"
+#include "Device.h"
+
+namespace VKKit {
+ParallelRecorder::ParallelRecorder(const Device& device, uint32_t thread_count) :
+    device{ &device }, current_frame{ 0 }, task{ nullptr }, inheritance{ nullptr }, count{ 0 }, slices{ 0 }, generation{ 0 }, pending{ 0 }
+{
+    // One set of pools per worker, plus one for the owning thread
+    pools.reserve((thread_count + 1) * MAX_FRAMES_IN_FLIGHT);
+    for (size_t i = 0; i < (thread_count + 1) * MAX_FRAMES_IN_FLIGHT; ++i)
+        pools.push_back(FramePool{ CommandPool(device, VkCommandPoolCreateFlags{}, device.GetGraphicsQueueIndex()), {}, 0 });
+
+    results.resize(thread_count);
+    errors.resize(thread_count);
+
+    workers.reserve(thread_count);
+    for (uint32_t i = 0; i < thread_count; ++i)
+        workers.emplace_back([this, i](std::stop_token stop) { Work(stop, i); });
+}
+
+ParallelRecorder::~ParallelRecorder()
+{
+    for (auto& worker : workers) worker.request_stop();
+    job_ready.notify_all();
+}
+
+void ParallelRecorder::BeginFrame(uint32_t frame)
+{
+    current_frame = frame;
+
+    // Resetting a pool resets every command buffer allocated from it, so they can be begun again
+    for (size_t thread = 0; thread <= workers.size(); ++thread) {
+        FramePool& p = pools[thread * MAX_FRAMES_IN_FLIGHT + frame];
+        if (p.used == 0) continue;
+
+        const auto result = vkResetCommandPool(device->Get(), p.pool.Get(), 0);
+        if (result != VK_SUCCESS) ThrowError("Failed to reset command pool.", result);
+        p.used = 0;
+    }
+}
+
+const CommandBuffer& ParallelRecorder::BeginSecondary(const VkCommandBufferInheritanceInfo& inheritance)
+{
+    return Begin(static_cast<uint32_t>(workers.size()), inheritance);
+}
+
+std::vector<VkCommandBuffer> ParallelRecorder::Record(size_t count, const VkCommandBufferInheritanceInfo& inheritance, const Task& task)
+{
+    if (count == 0) return {};
+
+    {
+        std::scoped_lock lock(mutex);
+
+        this->task = &task;
+        this->inheritance = &inheritance;
+        this->count = count;
+        slices = std::clamp<size_t>(count / MIN_ITEMS_PER_THREAD, 1, workers.size());
+        pending = workers.size();
+        ++generation;
+    }
+
+    job_ready.notify_all();
+
+    {
+        std::unique_lock lock(mutex);
+        job_done.wait(lock, [this] { return pending == 0; });
+    }
+
+    for (size_t i = 0; i < slices; ++i)
+        if (errors[i]) std::rethrow_exception(std::exchange(errors[i], nullptr));
+
+    return std::vector<VkCommandBuffer>(results.begin(), results.begin() + slices);
+}
+
+const CommandBuffer& ParallelRecorder::Begin(uint32_t thread, const VkCommandBufferInheritanceInfo& inheritance)
+{
+    FramePool& p = pools[thread * MAX_FRAMES_IN_FLIGHT + current_frame];
+    if (p.used == p.buffers.size()) p.buffers.emplace_back(*device, p.pool, VK_COMMAND_BUFFER_LEVEL_SECONDARY);
+
+    const CommandBuffer& command_buffer = p.buffers[p.used++];
+
+    const VkCommandBufferBeginInfo begin_info = {
+        .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+        .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        .pInheritanceInfo = &inheritance
+    };
+
+    const auto result = vkBeginCommandBuffer(command_buffer.GetBuffer(), &begin_info);
+    if (result != VK_SUCCESS) ThrowError("Failed to begin recording secondary command buffer.", result);
+
+    return command_buffer;
+}
+
+void ParallelRecorder::Work(std::stop_token stop, uint32_t thread)
+{
+    uint64_t seen = 0;
+
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            if (!job_ready.wait(lock, stop, [&] { return generation != seen; })) return;
+            seen = generation;
+        }
+
+        // Threads without a slice only report back
+        if (thread < slices) {
+            try {
+                const size_t first = count * thread / slices, last = count * (thread + 1) / slices;
+                const VkCommandBuffer command_buffer = Begin(thread, *inheritance).GetBuffer();
+
+                (*task)(command_buffer, first, last);
+
+                const auto result = vkEndCommandBuffer(command_buffer);
+                if (result != VK_SUCCESS) ThrowError("Failed to record secondary command buffer.", result);
+                results[thread] = command_buffer;
+            }
+            catch (...) {
+                errors[thread] = std::current_exception();
+            }
+        }
+
+        {
+            std::scoped_lock lock(mutex);
+            if (--pending == 0) job_done.notify_one();
+        }
+    }
+}
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+#ifndef PARALLELRECORDER_H
+#define PARALLELRECORDER_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <cstdint>
+#include "vulkan/vulkan.h"
+#include "CommandPool.h"
+#include "CommandBuffer.h"
+#include "Constants.h"
+
+namespace VKKit {
+class Device;
+
+// Records secondary command buffers on worker threads. Every thread, the one that owns the recorder included, has its own command pool
+// per frame in flight, so a pool is never used by two threads at once. A frame's pools are reset when the frame begins again, which
+// recycles its command buffers.
+class ParallelRecorder {
+public:
+    // Slices are never smaller than this, so short lists are recorded by fewer threads
+    static constexpr size_t MIN_ITEMS_PER_THREAD = 256;
+
+    // Records items [first, last) into command_buffer, which has been begun. Called on a worker thread.
+    using Task = std::function<void(VkCommandBuffer command_buffer, size_t first, size_t last)>;
+
+    /**
+     * @brief Start the worker threads and create their command pools
+     * @param device The logical device used. Command buffers are created for its graphics queue.
+     * @param thread_count The number of worker threads
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    ParallelRecorder(const Device& device, uint32_t thread_count);
+
+    // Stops the worker threads. The device must be done with the recorded command buffers.
+    ~ParallelRecorder();
+
+    ParallelRecorder(const ParallelRecorder&) = delete;
+    ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+    ParallelRecorder(ParallelRecorder&&) = delete;
+    ParallelRecorder& operator=(ParallelRecorder&&) = delete;
+
+    uint32_t GetThreadCount() const noexcept { return static_cast<uint32_t>(workers.size()); }
+
+    /**
+     * @brief Start recording frame. Resets the command pools of the frame, so the frame last recorded with this index must have finished
+     *        executing.
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    void BeginFrame(uint32_t frame);
+
+    /**
+     * @brief Begin a secondary command buffer on the calling thread, which must be the thread that owns the recorder
+     * @param inheritance The render pass, subpass and framebuffer the command buffer continues
+     * @return The command buffer. The reference stays valid until the next call.
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    const CommandBuffer& BeginSecondary(const VkCommandBufferInheritanceInfo& inheritance);
+
+    /**
+     * @brief Split items [0, count) into one slice per worker thread and record the slices in parallel, each into its own secondary
+     *        command buffer. Blocks until every slice has been recorded.
+     * @param count The number of items
+     * @param inheritance The render pass, subpass and framebuffer the command buffers continue
+     * @param task Records a slice. It must only record commands, everything it reads must already be written.
+     * @return The ended command buffers, in the order of their slices
+     *
+     * @throw std::runtime_error with error information on failure, or whatever task threw
+     */
+    std::vector<VkCommandBuffer> Record(size_t count, const VkCommandBufferInheritanceInfo& inheritance, const Task& task);
+
+private:
+    // The command buffers a thread recorded in one frame, reused once the frame comes around again
+    struct FramePool {
+        CommandPool pool;
+        std::vector<CommandBuffer> buffers;
+        size_t used;
+    };
+
+    const Device* device;
+    uint32_t current_frame;
+
+    // pools[thread * MAX_FRAMES_IN_FLIGHT + frame]. The owning thread's pools come after the workers'.
+    std::vector<FramePool> pools;
+
+    // The job being recorded
+    const Task* task;
+    const VkCommandBufferInheritanceInfo* inheritance;
+    size_t count, slices;
+    std::vector<VkCommandBuffer> results;
+    std::vector<std::exception_ptr> errors;
+
+    uint64_t generation; // Incremented for every job, so the workers can tell a new job from a spurious wakeup
+    size_t pending;      // Workers that haven't finished the current job
+    std::mutex mutex;
+    std::condition_variable_any job_ready;
+    std::condition_variable job_done;
+
+    // Declared last so the threads are joined before anything they use is destroyed
+    std::vector<std::jthread> workers;
+
+    const CommandBuffer& Begin(uint32_t thread, const VkCommandBufferInheritanceInfo& inheritance);
+    void Work(std::stop_token stop, uint32_t thread);
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,22 @@
+#ifndef RECORDINGSTATS_H
+#define RECORDINGSTATS_H
+
+#include <cstdint>
+
+namespace VKKit {
+// How many binds (pipelines, descriptor sets, vertex and index buffers, viewports and scissors) the draws of a frame asked for, and how
+// many of them were skipped because what they would have bound was already bound
+struct RecordingStats {
+    uint64_t binds;        // Binds recorded into command buffers
+    uint64_t elided_binds; // Binds skipped
+
+    RecordingStats& operator+=(const RecordingStats& other) noexcept
+    {
+        binds += other.binds;
+        elided_binds += other.elided_binds;
+        return *this;
+    }
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include <array>
+#include "RectBatch.h"
+#include "Device.h"
+
+namespace VKKit {
+static_assert(sizeof(RectBatch::Instance) == 8 * sizeof(float), "The Color2D pipeline expects tightly packed instances");
+
+RectBatch::RectBatch(const Device& device)
+{
+    static constexpr std::array<float, 8> corners = {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 1.0f
+    };
+
+    static constexpr std::array<uint32_t, 6> indices = {
+        0, 1, 2, 2, 3, 0
+    };
+
+    quad = MeshBuffer(device, corners, indices);
+}
+
+void RectBatch::Flush(BindCache& binds, RingBuffer& geometry, VkPipeline pipeline)
+{
+    if (instances.empty()) return;
+
+    const auto range = geometry.Push(instances.data(), instances.size() * sizeof(Instance), sizeof(float));
+
+    binds.BindPipeline(pipeline);
+    Draw(binds, range.buffer, range.offset, static_cast<uint32_t>(instances.size()));
+
+    Clear();
+}
+
+void RectBatch::Draw(BindCache& binds, VkBuffer instances, VkDeviceSize offset, uint32_t count) const noexcept
+{
+    quad.Bind(binds);
+    binds.BindVertexBuffer(1, instances, offset);
+
+    vkCmdDrawIndexed(binds.Get(), quad.GetIndexCount(), count, 0, 0, 0);
+}
+}
\ No newline at end of file
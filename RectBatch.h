@@ -0,0 +1,72 @@
+#ifndef RECTBATCH_H
+#define RECTBATCH_H
+
+#include <vector>
+#include "vulkan/vulkan.h"
+#include "RenderData.h"
+#include "MeshBuffer.h"
+#include "RingBuffer.h"
+#include "BindCache.h"
+
+namespace VKKit {
+class Device;
+
+// Accumulates solid rectangles on the CPU and draws all of them with one instanced draw of a unit quad. Like SpriteBatch, the batch has
+// to be flushed before anything else is drawn on top of the rectangles.
+class RectBatch {
+public:
+    // The per instance data read by the Color2D pipeline
+    struct Instance {
+        Rect area;
+        Color color;
+    };
+
+    RectBatch() = default;
+
+    /**
+     * @brief Create a rectangle batch. The unit quad is uploaded immediately.
+     * @param device The logical device used
+     * @throw std::runtime_error with error information on failure
+     */
+    explicit RectBatch(const Device& device);
+
+    /**
+     * @brief Queue a rectangle
+     * @param color The colour of the rectangle
+     * @param area Where to draw the rectangle (in normalized Vulkan coordinates)
+     */
+    void Add(Color color, Rect area) { instances.push_back(Instance{ area, color }); }
+
+    bool Empty() const noexcept { return instances.empty(); }
+
+    /**
+     * @brief Draw every queued rectangle and empty the batch
+     *
+     * @param binds The bind cache of the command buffer to record to. It must have a render pass that the pipeline is compatible with
+     *              active.
+     * @param geometry The ring buffer the instances are written to. It must not be reset before the command buffer has finished executing.
+     * @param pipeline The Color2D pipeline
+     *
+     * @throw std::runtime_error with error information if the ring buffer can't grow
+     */
+    void Flush(BindCache& binds, RingBuffer& geometry, VkPipeline pipeline);
+
+    /**
+     * @brief Draw instances that are already in a buffer, e.g. retained rectangles
+     * @param binds The bind cache of the command buffer to record to. The Color2D pipeline must be bound.
+     * @param instances The buffer of the instances
+     * @param offset The offset of the first instance in the buffer
+     * @param count The number of instances to draw
+     */
+    void Draw(BindCache& binds, VkBuffer instances, VkDeviceSize offset, uint32_t count) const noexcept;
+
+    // Drop every queued rectangle without drawing
+    void Clear() noexcept { instances.clear(); }
+
+private:
+    std::vector<Instance> instances;
+    MeshBuffer quad;
+};
+}
+
+#endif
\ No newline at end of file
@@ -1,8 +1,17 @@
 #include <array>
 #include "RenderData.h"
 #include "vulkan/vulkan.h"
+#include "glm/gtc/matrix_transform.hpp"
 
 namespace VKKit {
+Instance3D Instance3D::FromCuboid(Cuboid area, Color color)
+{
+    return Instance3D {
+        .transform = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(area.x, area.y, area.z)), glm::vec3(area.w, area.h, area.d)),
+        .color = color
+    };
+}
+
 RenderData RenderData::CreateTexturedRect(Rect r)
 {
     return RenderData {
@@ -106,6 +106,21 @@ struct CameraView {
     alignas(16) glm::mat4 proj;
 };
 
+// The per instance data of the instanced 3D draws
+struct Instance3D {
+    glm::mat4 transform; // Applied to the mesh before the camera's model matrix
+    Color color;         // The colour of a colored cuboid, or the tint that the texture of a textured draw is multiplied by
+
+    // An instance that stretches the unit cube (0, 0, 0) - (1, 1, 1) over area
+    static Instance3D FromCuboid(Cuboid area, Color color = { 1.0f, 1.0f, 1.0f, 1.0f });
+};
+
+// Part of a page of a texture atlas (see Context::LoadAtlas)
+struct AtlasRegion {
+    size_t texture; // The index of the page in the context's array of textures
+    Rect src;       // Where the image is on the page, in texture coordinates
+};
+
 struct Vertex {
     glm::vec3 pos;
     glm::vec3 color;
@@ -0,0 +1,242 @@
+#include <stdexcept>
+#include "RetainedScene.h"
+#include "Device.h"
+
+namespace VKKit {
+// A zero matrix collapses every vertex onto the origin, so the instance draws nothing
+static Instance3D EmptyInstance() noexcept
+{
+    return Instance3D{ .transform = glm::mat4(0.0f), .color = { 0.0f, 0.0f, 0.0f, 0.0f } };
+}
+
+RetainedScene::RetainedScene(const Device& device) :
+    colored_quads(device, RectBatch::Instance{}),
+    textured_quads(device, SpriteBatch::Quad{}),
+    colored_cuboids(device, EmptyInstance()),
+    textured_cuboids(device, EmptyInstance()),
+    model_instances(device, EmptyInstance()),
+    device{ &device }
+{}
+
+ObjectHandle RetainedScene::CreateQuad(Color color, Rect area)
+{
+    return ObjectHandle{ ObjectType::COLORED_QUAD, colored_quads.Add(RectBatch::Instance{ area, color }, 0) };
+}
+
+ObjectHandle RetainedScene::CreateQuad(size_t texture, Rect dst)
+{
+    return ObjectHandle{ ObjectType::TEXTURED_QUAD, textured_quads.Add(SpriteBatch::MakeQuad(texture, dst), texture) };
+}
+
+ObjectHandle RetainedScene::CreateCuboid(Color color, Cuboid area)
+{
+    return ObjectHandle{ ObjectType::COLORED_CUBOID, colored_cuboids.Add(Instance3D::FromCuboid(area, color), 0) };
+}
+
+ObjectHandle RetainedScene::CreateCuboid(size_t texture, Cuboid area)
+{
+    return ObjectHandle{ ObjectType::TEXTURED_CUBOID, textured_cuboids.Add(Instance3D::FromCuboid(area), texture) };
+}
+
+ObjectHandle RetainedScene::CreateModelInstance(size_t texture, const Model& model, const glm::mat4& transform)
+{
+    const Instance3D instance = { .transform = transform, .color = { 1.0f, 1.0f, 1.0f, 1.0f } };
+    return ObjectHandle{ ObjectType::MODEL_INSTANCE, model_instances.Add(instance, ModelGroup{ &model, texture }) };
+}
+
+ObjectHandle RetainedScene::CreateTextBlock(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
+    HorizontalAlignment halign, VerticalAlignment valign)
+{
+    TextBlock block = {
+        .text = std::string(text),
+        .font_style = font_style,
+        .color = color,
+        .x = x, .y = y, .size = size, .row_width = row_width,
+        .halign = halign,
+        .valign = valign,
+        .visible = true,
+        .alive = true,
+        .laid_out = false
+    };
+
+    if (free_text_blocks.empty()) {
+        block.vertices = BufferVec<float>(*device, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT);
+        text_blocks.push_back(std::move(block));
+        return ObjectHandle{ ObjectType::TEXT_BLOCK, static_cast<uint32_t>(text_blocks.size() - 1) };
+    }
+
+    const uint32_t i = free_text_blocks.back();
+    free_text_blocks.pop_back();
+
+    // Frames in flight may still be drawing the old text from the vertex buffer, which BufferVec overwrites in queue order
+    block.vertices = std::move(text_blocks[i].vertices);
+    text_blocks[i] = std::move(block);
+    return ObjectHandle{ ObjectType::TEXT_BLOCK, i };
+}
+
+// Throw if object isn't a live object of its pool
+template<typename T, typename Group>
+static void Check(const ObjectPool<T, Group>& pool, ObjectHandle object)
+{
+    if (!pool.Contains(object.index)) throw std::runtime_error("The object doesn't exist");
+}
+
+void RetainedScene::SetArea(ObjectHandle object, Rect area)
+{
+    switch (object.type) {
+    case ObjectType::COLORED_QUAD: {
+        Check(colored_quads, object);
+        RectBatch::Instance instance = colored_quads.Get(object.index);
+        instance.area = area;
+        colored_quads.Set(object.index, instance);
+        break;
+    }
+    case ObjectType::TEXTURED_QUAD:
+        Check(textured_quads, object);
+        textured_quads.Set(object.index, SpriteBatch::MakeQuad(textured_quads.GetGroup(object.index), area));
+        break;
+    default:
+        throw std::runtime_error("Only quads have a rectangular area");
+    }
+}
+
+void RetainedScene::SetArea(ObjectHandle object, Cuboid area)
+{
+    auto set_area = [&](ObjectPool<Instance3D, size_t>& pool) {
+        Check(pool, object);
+        pool.Set(object.index, Instance3D::FromCuboid(area, pool.Get(object.index).color));
+    };
+
+    switch (object.type) {
+    case ObjectType::COLORED_CUBOID: set_area(colored_cuboids); break;
+    case ObjectType::TEXTURED_CUBOID: set_area(textured_cuboids); break;
+    default: throw std::runtime_error("Only cuboids have a cuboid area");
+    }
+}
+
+void RetainedScene::SetTransform(ObjectHandle object, const glm::mat4& transform)
+{
+    auto set_transform = [&](auto& pool) {
+        Check(pool, object);
+        Instance3D instance = pool.Get(object.index);
+        instance.transform = transform;
+        pool.Set(object.index, instance);
+    };
+
+    switch (object.type) {
+    case ObjectType::COLORED_CUBOID: set_transform(colored_cuboids); break;
+    case ObjectType::TEXTURED_CUBOID: set_transform(textured_cuboids); break;
+    case ObjectType::MODEL_INSTANCE: set_transform(model_instances); break;
+    default: throw std::runtime_error("Only cuboids and model instances have a transform");
+    }
+}
+
+void RetainedScene::SetColor(ObjectHandle object, Color color)
+{
+    auto set_color = [&](auto& pool) {
+        Check(pool, object);
+        auto value = pool.Get(object.index);
+        value.color = color;
+        pool.Set(object.index, value);
+    };
+
+    switch (object.type) {
+    case ObjectType::COLORED_QUAD: set_color(colored_quads); break;
+    case ObjectType::COLORED_CUBOID: set_color(colored_cuboids); break;
+    case ObjectType::TEXTURED_CUBOID: set_color(textured_cuboids); break;
+    case ObjectType::MODEL_INSTANCE: set_color(model_instances); break;
+    case ObjectType::TEXT_BLOCK: GetTextBlock(object).color = color; break; // A push constant, the layout stays
+    default: throw std::runtime_error("Textured quads don't have a color");
+    }
+}
+
+void RetainedScene::SetText(ObjectHandle object, std::string_view text)
+{
+    if (object.type != ObjectType::TEXT_BLOCK) throw std::runtime_error("Only text blocks have text");
+
+    TextBlock& block = GetTextBlock(object);
+    block.text = text;
+    block.laid_out = false;
+}
+
+void RetainedScene::SetFont(ObjectHandle object, size_t font_style, float size)
+{
+    if (object.type != ObjectType::TEXT_BLOCK) throw std::runtime_error("Only text blocks have a font");
+
+    TextBlock& block = GetTextBlock(object);
+    block.font_style = font_style;
+    block.size = size;
+    block.laid_out = false;
+}
+
+void RetainedScene::SetPosition(ObjectHandle object, float x, float y)
+{
+    if (object.type != ObjectType::TEXT_BLOCK) throw std::runtime_error("Only text blocks have a position");
+
+    TextBlock& block = GetTextBlock(object);
+    block.x = x;
+    block.y = y;
+    block.laid_out = false;
+}
+
+void RetainedScene::SetVisible(ObjectHandle object, bool visible)
+{
+    auto set_visible = [&](auto& pool) {
+        Check(pool, object);
+        pool.SetVisible(object.index, visible);
+    };
+
+    switch (object.type) {
+    case ObjectType::COLORED_QUAD: set_visible(colored_quads); break;
+    case ObjectType::TEXTURED_QUAD: set_visible(textured_quads); break;
+    case ObjectType::COLORED_CUBOID: set_visible(colored_cuboids); break;
+    case ObjectType::TEXTURED_CUBOID: set_visible(textured_cuboids); break;
+    case ObjectType::MODEL_INSTANCE: set_visible(model_instances); break;
+    case ObjectType::TEXT_BLOCK: GetTextBlock(object).visible = visible; break;
+    }
+}
+
+void RetainedScene::Destroy(ObjectHandle object)
+{
+    auto destroy = [&](auto& pool) {
+        Check(pool, object);
+        pool.Remove(object.index);
+    };
+
+    switch (object.type) {
+    case ObjectType::COLORED_QUAD: destroy(colored_quads); break;
+    case ObjectType::TEXTURED_QUAD: destroy(textured_quads); break;
+    case ObjectType::COLORED_CUBOID: destroy(colored_cuboids); break;
+    case ObjectType::TEXTURED_CUBOID: destroy(textured_cuboids); break;
+    case ObjectType::MODEL_INSTANCE: destroy(model_instances); break;
+    case ObjectType::TEXT_BLOCK: {
+        TextBlock& block = GetTextBlock(object);
+        block.alive = false;
+        block.text.clear();
+        block.vertices.clear();
+        free_text_blocks.push_back(object.index);
+        break;
+    }
+    }
+}
+
+void RetainedScene::Flush()
+{
+    colored_quads.Flush();
+    textured_quads.Flush();
+    colored_cuboids.Flush();
+    textured_cuboids.Flush();
+    model_instances.Flush();
+}
+
+void RetainedScene::InvalidateText() noexcept
+{
+    for (auto& block : text_blocks) block.laid_out = false;
+}
+
+RetainedScene::TextBlock& RetainedScene::GetTextBlock(ObjectHandle object)
+{
+    if (object.index >= text_blocks.size() || !text_blocks[object.index].alive) throw std::runtime_error("The text block doesn't exist");
+    return text_blocks[object.index];
+}
+}
\ No newline at end of file
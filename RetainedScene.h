@@ -0,0 +1,202 @@
+#ifndef RETAINEDSCENE_H
+#define RETAINEDSCENE_H
+
+#include <vector>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include "vulkan/vulkan.h"
+#include "Context.h"
+#include "RenderData.h"
+#include "BufferVec.h"
+#include "RectBatch.h"
+#include "SpriteBatch.h"
+
+namespace VKKit {
+class Device;
+class Model;
+
+// Objects of one kind, kept in a device buffer that is only written when an object changes. Destroyed objects leave a free slot that
+// the next object reuses. Hidden and free slots are overwritten with an empty value that draws nothing, so runs of slots can be drawn
+// without skipping them. Objects are drawn in runs of consecutive slots with the same Group (e.g. the same texture).
+template<typename T, typename Group>
+class ObjectPool {
+public:
+    ObjectPool() = default;
+    ObjectPool(const Device& device, const T& empty) : gpu(device, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT), empty{ empty } {}
+
+    uint32_t Add(const T& value, const Group& group)
+    {
+        if (free.empty()) {
+            slots.push_back(Slot{ value, group, State::VISIBLE });
+            gpu.push_back(value);
+            return static_cast<uint32_t>(slots.size() - 1);
+        }
+
+        const uint32_t i = free.back();
+        free.pop_back();
+        slots[i] = Slot{ value, group, State::VISIBLE };
+        gpu[i] = value;
+        return i;
+    }
+
+    void Set(uint32_t i, const T& value)
+    {
+        slots[i].value = value;
+        if (slots[i].state == State::VISIBLE) gpu[i] = value;
+    }
+
+    void SetVisible(uint32_t i, bool visible)
+    {
+        slots[i].state = visible ? State::VISIBLE : State::HIDDEN;
+        gpu[i] = visible ? slots[i].value : empty;
+    }
+
+    bool IsVisible(uint32_t i) const noexcept { return slots[i].state == State::VISIBLE; }
+
+    void Remove(uint32_t i)
+    {
+        slots[i].state = State::FREE;
+        gpu[i] = empty;
+        free.push_back(i);
+    }
+
+    bool Contains(uint32_t i) const noexcept { return i < slots.size() && slots[i].state != State::FREE; }
+    const T& Get(uint32_t i) const noexcept { return slots[i].value; }
+    const Group& GetGroup(uint32_t i) const noexcept { return slots[i].group; }
+
+    // Upload the objects that changed since the last call. Call before drawing the pool.
+    void Flush() { if (!gpu.empty()) gpu.Flush(); }
+
+    VkBuffer GetBuffer() const noexcept { return gpu.GetBuffer(); }
+    bool Empty() const noexcept { return gpu.empty(); }
+    // The number of slots, which is the number of values in the buffer
+    uint32_t Size() const noexcept { return static_cast<uint32_t>(gpu.size()); }
+
+    // Call f(group, first, count) for every run of slots that can be drawn together. Free slots join whatever run they are in.
+    template<typename F>
+    void ForEachRun(F&& f) const
+    {
+        const Group* group = nullptr;
+        uint32_t first = 0;
+
+        for (uint32_t i = 0; i < slots.size(); ++i) {
+            if (slots[i].state == State::FREE) continue;
+            if (group != nullptr && *group == slots[i].group) continue;
+
+            if (group != nullptr) f(*group, first, i - first);
+            group = &slots[i].group;
+            first = i;
+        }
+
+        if (group != nullptr) f(*group, first, static_cast<uint32_t>(slots.size()) - first);
+    }
+
+private:
+    enum class State : uint8_t { FREE, VISIBLE, HIDDEN };
+
+    struct Slot {
+        T value;
+        Group group;
+        State state;
+    };
+
+    BufferVec<T> gpu;
+    T empty;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> free;
+};
+
+// The objects created with Context::CreateQuad, CreateCuboid, CreateModelInstance and CreateTextBlock. Their geometry stays on the GPU
+// between frames, and only objects that changed are uploaded again. Text blocks are laid out again only when their text, font, size or
+// position changes, or when the swapchain is resized.
+class RetainedScene {
+public:
+    // The model and texture of a run of model instances
+    struct ModelGroup {
+        const Model* model;
+        size_t texture;
+
+        bool operator==(const ModelGroup&) const = default;
+    };
+
+    struct TextBlock {
+        std::string text;
+        size_t font_style;
+        Color color;
+        float x, y, size, row_width;
+        HorizontalAlignment halign;
+        VerticalAlignment valign;
+        bool visible;
+        bool alive; // false once destroyed, until the slot is reused
+        bool laid_out; // false when vertices is out of date
+        BufferVec<float> vertices; // The glyph quads of the text, laid out by Alphabet::LayoutTextRel. Kept when the slot is reused.
+    };
+
+    RetainedScene() noexcept : device{ nullptr } {}
+    explicit RetainedScene(const Device& device);
+
+    ObjectHandle CreateQuad(Color color, Rect area);
+    ObjectHandle CreateQuad(size_t texture, Rect dst);
+    ObjectHandle CreateCuboid(Color color, Cuboid area);
+    ObjectHandle CreateCuboid(size_t texture, Cuboid area);
+    ObjectHandle CreateModelInstance(size_t texture, const Model& model, const glm::mat4& transform);
+    ObjectHandle CreateTextBlock(std::string_view text, size_t font_style, Color color, float x, float y, float size, float row_width,
+        HorizontalAlignment halign, VerticalAlignment valign);
+
+    // The setters throw std::runtime_error if the object doesn't exist or doesn't have the property
+    void SetArea(ObjectHandle object, Rect area);
+    void SetArea(ObjectHandle object, Cuboid area);
+    void SetTransform(ObjectHandle object, const glm::mat4& transform);
+    void SetColor(ObjectHandle object, Color color);
+    void SetText(ObjectHandle object, std::string_view text);
+    void SetFont(ObjectHandle object, size_t font_style, float size);
+    void SetPosition(ObjectHandle object, float x, float y);
+    void SetVisible(ObjectHandle object, bool visible);
+    void Destroy(ObjectHandle object);
+
+    // Upload every object that changed since the last call
+    void Flush();
+
+    // Lay out the text blocks that changed since the last call and upload their vertices. layout(block) returns the vertices of block.
+    template<typename Layout>
+    void FlushText(Layout&& layout)
+    {
+        for (auto& block : text_blocks) {
+            if (!block.alive || block.laid_out) continue;
+
+            const std::vector<float>& vertices = layout(static_cast<const TextBlock&>(block));
+            block.vertices.clear();
+            block.vertices.resize(vertices.size());
+            block.vertices.Write(0, vertices.data(), vertices.size());
+            block.vertices.Flush();
+            block.laid_out = true;
+        }
+    }
+
+    // Lay out every text block again on the next FlushText(), e.g. because the swapchain extent changed
+    void InvalidateText() noexcept;
+
+    const ObjectPool<RectBatch::Instance, size_t>& GetColoredQuads() const noexcept { return colored_quads; }
+    const ObjectPool<SpriteBatch::Quad, size_t>& GetTexturedQuads() const noexcept { return textured_quads; }
+    const ObjectPool<Instance3D, size_t>& GetColoredCuboids() const noexcept { return colored_cuboids; }
+    const ObjectPool<Instance3D, size_t>& GetTexturedCuboids() const noexcept { return textured_cuboids; }
+    const ObjectPool<Instance3D, ModelGroup>& GetModelInstances() const noexcept { return model_instances; }
+    const std::vector<TextBlock>& GetTextBlocks() const noexcept { return text_blocks; }
+
+private:
+    ObjectPool<RectBatch::Instance, size_t> colored_quads;
+    ObjectPool<SpriteBatch::Quad, size_t> textured_quads; // Grouped by texture
+    ObjectPool<Instance3D, size_t> colored_cuboids;
+    ObjectPool<Instance3D, size_t> textured_cuboids; // Grouped by texture
+    ObjectPool<Instance3D, ModelGroup> model_instances;
+
+    const Device* device; // For the vertex buffers of new text blocks
+    std::vector<TextBlock> text_blocks;
+    std::vector<uint32_t> free_text_blocks;
+
+    TextBlock& GetTextBlock(ObjectHandle object);
+};
+}
+
+#endif
\ No newline at end of file
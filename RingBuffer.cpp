@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include "RingBuffer.h"
+#include "Device.h"
+
+namespace VKKit {
+static constexpr VkDeviceSize AlignUp(VkDeviceSize value, VkDeviceSize alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+RingBuffer::RingBuffer() noexcept :
+    physical_device{ nullptr }, device{ nullptr }, usage{ 0 }, chunk_size{ 0 }, current_chunk{ 0 }, position{ 0 }
+{}
+
+RingBuffer::RingBuffer(VkPhysicalDevice physical_device, const Device& device, VkBufferUsageFlags usage, VkDeviceSize chunk_size) :
+    physical_device{ physical_device }, device{ &device }, usage{ usage }, chunk_size{ chunk_size }, current_chunk{ 0 }, position{ 0 }
+{
+    AddChunk(chunk_size);
+}
+
+RingBuffer::RingBuffer(RingBuffer&& r) noexcept :
+    physical_device{ r.physical_device }, device{ r.device }, usage{ r.usage }, chunk_size{ r.chunk_size }, chunks{ std::move(r.chunks) },
+    chunk_sizes{ std::move(r.chunk_sizes) }, current_chunk{ r.current_chunk }, position{ r.position }
+{
+    r.device = nullptr;
+    r.current_chunk = 0;
+    r.position = 0;
+}
+
+RingBuffer& RingBuffer::operator=(RingBuffer&& r) noexcept
+{
+    physical_device = r.physical_device;
+    device = r.device;
+    usage = r.usage;
+    chunk_size = r.chunk_size;
+    chunks = std::move(r.chunks);
+    chunk_sizes = std::move(r.chunk_sizes);
+    current_chunk = r.current_chunk;
+    position = r.position;
+
+    r.device = nullptr;
+    r.current_chunk = 0;
+    r.position = 0;
+
+    return *this;
+}
+
+RingBuffer::Range RingBuffer::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+    // A default constructed or moved from ring buffer has no device to create chunks with
+    if (chunks.empty()) throw std::runtime_error("Allocating from a ring buffer that was default constructed or moved from");
+
+    VkDeviceSize offset = AlignUp(position, std::max<VkDeviceSize>(alignment, 1));
+
+    if (offset + size > chunk_sizes[current_chunk]) {
+        // Move on to the next chunk that can hold the data, creating one if none of the remaining chunks is big enough
+        do ++current_chunk;
+        while (current_chunk < chunks.size() && chunk_sizes[current_chunk] < size);
+
+        if (current_chunk == chunks.size()) AddChunk(std::max(chunk_size, size));
+        offset = 0;
+    }
+
+    position = offset + size;
+
+    return Range {
+        .buffer = chunks[current_chunk].GetBuffer(),
+        .offset = offset,
+        .data = static_cast<char*>(chunks[current_chunk].GetMapped()) + offset
+    };
+}
+
+RingBuffer::Range RingBuffer::Push(const void* data, VkDeviceSize size, VkDeviceSize alignment)
+{
+    const Range range = Allocate(size, alignment);
+    memcpy(range.data, data, size);
+    return range;
+}
+
+void RingBuffer::Reset() noexcept
+{
+    current_chunk = 0;
+    position = 0;
+}
+
+void RingBuffer::AddChunk(VkDeviceSize size)
+{
+    // Chunks are only ever written by the CPU and read once by the GPU, so host visible memory is read directly instead of being copied
+    // into device local memory first. Where device local memory is host visible the policy puts them there.
+    chunks.emplace_back(*device, size, usage, MemoryUsage::DYNAMIC);
+    chunk_sizes.push_back(size);
+}
+}
\ No newline at end of file
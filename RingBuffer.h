@@ -0,0 +1,84 @@
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <vector>
+#include "vulkan/vulkan.h"
+#include "Buffer.h"
+
+namespace VKKit {
+class Device;
+
+// A persistently mapped, host visible buffer which transient geometry is appended to while a frame is being recorded. Keep one per frame
+// in flight and reset it once the frame's fence has signalled. When a chunk runs out of space a new one is chained on, so appending never
+// has to wait for the GPU.
+class RingBuffer {
+public:
+    static constexpr VkDeviceSize DEFAULT_CHUNK_SIZE = 8ull * 1024 * 1024;
+
+    // A range of the ring buffer that data has been written to
+    struct Range {
+        VkBuffer buffer;
+        VkDeviceSize offset;
+        void* data;
+    };
+
+    RingBuffer() noexcept;
+
+    /**
+     * @brief Create a ring buffer. The first chunk is allocated immediately.
+     *
+     * @param physical_device The physical device used
+     * @param device The logical device whose allocator the chunks are allocated from
+     * @param usage How the ring buffer will be used (e.g. VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+     * @param chunk_size The size of each chunk. Allocations larger than a chunk get a chunk of their own.
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    RingBuffer(VkPhysicalDevice physical_device, const Device& device, VkBufferUsageFlags usage, VkDeviceSize chunk_size = DEFAULT_CHUNK_SIZE);
+
+    RingBuffer(const RingBuffer&) = delete;
+    RingBuffer& operator=(const RingBuffer&) = delete;
+    RingBuffer(RingBuffer&& r) noexcept;
+    RingBuffer& operator=(RingBuffer&& r) noexcept;
+
+    /**
+     * @brief Reserve space in the ring buffer
+     * @param size The number of bytes to reserve
+     * @param alignment The required alignment of the offset of the range
+     * @return The reserved range. Write the data to range.data and bind range.buffer at range.offset.
+     *
+     * @throw std::runtime_error with error information if a new chunk has to be created and that fails, or if the ring buffer was default
+     * constructed or moved from
+     */
+    Range Allocate(VkDeviceSize size, VkDeviceSize alignment = 4);
+
+    /**
+     * @brief Copy data to the ring buffer
+     * @param data The data to copy
+     * @param size The size of the data in bytes
+     * @param alignment The required alignment of the offset of the range
+     * @return The range the data was written to
+     *
+     * @throw std::runtime_error with error information if a new chunk has to be created and that fails
+     */
+    Range Push(const void* data, VkDeviceSize size, VkDeviceSize alignment = 4);
+
+    // Start writing from the beginning again. The GPU must not be reading anything written since the last reset.
+    void Reset() noexcept;
+
+private:
+    VkPhysicalDevice physical_device;
+    const Device* device;
+    VkBufferUsageFlags usage;
+    VkDeviceSize chunk_size;
+
+    std::vector<Buffer> chunks;
+    std::vector<VkDeviceSize> chunk_sizes;
+    size_t current_chunk;
+    VkDeviceSize position;
+
+    void AddChunk(VkDeviceSize size);
+};
+}
+
+#endif
\ No newline at end of file
@@ -1,13 +1,17 @@
 #version 450
 
-layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec4 aColor;
+// Per vertex: a corner of the unit quad
+layout (location = 0) in vec2 aCorner;
+
+// Per instance: the rectangle (x, y, w, h) and its colour
+layout (location = 1) in vec4 aRect;
+layout (location = 2) in vec4 aColor;
 
 layout (location = 0) out vec4 fragColor;
 
 void main()
 {
-    gl_Position = vec4(aPos, 1.0);
+    gl_Position = vec4(aRect.xy + aCorner * aRect.zw, 0.0, 1.0);
 
     fragColor = aColor;
 }
\ No newline at end of file
@@ -1,10 +1,14 @@
 #version 450
 
-layout (binding = 0) uniform CameraView {
+// The projection and view of the camera, at a dynamic offset per camera
+layout (binding = 0) uniform Camera {
+    mat4 view_proj;
+} camera;
+
+// The model matrix of the draw
+layout (push_constant) uniform Transform {
     mat4 model;
-    mat4 view;
-    mat4 proj;
-} cv;
+} transform;
 
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec4 aColor;
@@ -13,7 +17,7 @@ layout (location = 0) out vec4 fragColor;
 
 void main()
 {
-    gl_Position = cv.proj * cv.view * cv.model * vec4(aPos, 1.0);
+    gl_Position = camera.view_proj * transform.model * vec4(aPos, 1.0);
 
     fragColor = aColor;
 }
\ No newline at end of file
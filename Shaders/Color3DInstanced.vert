@@ -0,0 +1,26 @@
+#version 450
+
+// The projection and view of the camera, at a dynamic offset per camera
+layout (binding = 0) uniform Camera {
+    mat4 view_proj;
+} camera;
+
+// The model matrix of the draw
+layout (push_constant) uniform Transform {
+    mat4 model;
+} transform;
+
+layout (location = 0) in vec3 aPos;
+
+// Per instance
+layout (location = 1) in mat4 aTransform;
+layout (location = 5) in vec4 aColor;
+
+layout (location = 0) out vec4 fragColor;
+
+void main()
+{
+    gl_Position = camera.view_proj * transform.model * aTransform * vec4(aPos, 1.0);
+
+    fragColor = aColor;
+}
\ No newline at end of file
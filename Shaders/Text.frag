@@ -5,7 +5,7 @@ layout (location = 0) in vec2 texPos;
 layout (location = 0) out vec4 outColor;
 
 layout (binding = 0) uniform sampler2D bitmap;
-layout (binding = 1) uniform TextColor { vec4 value; } color;
+layout (push_constant) uniform TextColor { vec4 value; } color;
 
 void main()
 {
@@ -0,0 +1,15 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec2 fragTexCoord;
+layout (location = 1) flat in uint fragTexture;
+
+layout (location = 0) out vec4 outColor;
+
+// Every loaded texture, indexed by the texture index of the sprite
+layout (binding = 0) uniform sampler2D textures[];
+
+void main()
+{
+    outColor = texture(textures[nonuniformEXT(fragTexture)], fragTexCoord);
+}
\ No newline at end of file
@@ -0,0 +1,15 @@
+#version 450
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexPos;
+layout (location = 2) in uint aTexture;
+
+layout (location = 0) out vec2 fragTexCoord;
+layout (location = 1) flat out uint fragTexture;
+
+void main()
+{
+    gl_Position = vec4(aPos, 1.0);
+    fragTexCoord = aTexPos;
+    fragTexture = aTexture;
+}
\ No newline at end of file
@@ -1,10 +1,14 @@
 #version 450
 
-layout (binding = 0) uniform UniformBufferObject {
+// The projection and view of the camera, at a dynamic offset per camera
+layout (binding = 0) uniform Camera {
+    mat4 view_proj;
+} camera;
+
+// The model matrix of the draw
+layout (push_constant) uniform Transform {
     mat4 model;
-    mat4 view;
-    mat4 proj;
-} ubo;
+} transform;
 
 layout (location = 0) in vec3 inPosition;
 layout (location = 1) in vec2 inTexCoord;
@@ -13,6 +17,6 @@ layout (location = 0) out vec2 fragTexCoord;
 
 void main()
 {
-    gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+    gl_Position = camera.view_proj * transform.model * vec4(inPosition, 1.0);
     fragTexCoord = inTexCoord;
 }
\ No newline at end of file
@@ -0,0 +1,19 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout (location = 0) in vec2 fragTexCoord;
+
+layout (location = 0) out vec4 outColor;
+
+// The index of the draw's texture, pushed after the model matrix of the vertex shader
+layout (push_constant) uniform Material {
+    layout (offset = 64) uint texture;
+} material;
+
+// Every loaded texture
+layout (set = 1, binding = 0) uniform sampler2D textures[];
+
+void main()
+{
+    outColor = texture(textures[material.texture], fragTexCoord);
+}
\ No newline at end of file
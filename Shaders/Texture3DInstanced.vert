@@ -0,0 +1,28 @@
+#version 450
+
+// The projection and view of the camera, at a dynamic offset per camera
+layout (binding = 0) uniform Camera {
+    mat4 view_proj;
+} camera;
+
+// The model matrix of the draw
+layout (push_constant) uniform Transform {
+    mat4 model;
+} transform;
+
+layout (location = 0) in vec3 inPosition;
+layout (location = 1) in vec2 inTexCoord;
+
+// Per instance
+layout (location = 2) in mat4 inTransform;
+layout (location = 6) in vec4 inColor;
+
+layout (location = 0) out vec2 fragTexCoord;
+layout (location = 1) out vec4 fragColor;
+
+void main()
+{
+    gl_Position = camera.view_proj * transform.model * inTransform * vec4(inPosition, 1.0);
+    fragTexCoord = inTexCoord;
+    fragColor = inColor;
+}
\ No newline at end of file
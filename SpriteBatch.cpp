@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <bit>
+#include "SpriteBatch.h"
+#include "Device.h"
+
+namespace VKKit {
+SpriteBatch::SpriteBatch(VkPhysicalDevice physical_device, const Device& device)
+{
+    std::vector<uint32_t> quad_indices;
+    quad_indices.reserve(MAX_SPRITES_PER_DRAW * 6);
+
+    for (uint32_t i = 0; i < MAX_SPRITES_PER_DRAW; ++i) {
+        const uint32_t v = i * 4;
+        quad_indices.insert(quad_indices.end(), { v, v + 1, v + 2, v + 2, v + 3, v });
+    }
+
+    indices = Buffer::CreateIndexBuffer(physical_device, device, quad_indices);
+}
+
+void SpriteBatch::Add(size_t texture, Rect dst, Rect src)
+{
+    const Quad quad = MakeQuad(texture, dst, src);
+
+    const auto sprite = static_cast<uint32_t>(vertices.size() / (4 * FLOATS_PER_VERTEX));
+    vertices.insert(vertices.end(), quad.begin(), quad.end());
+
+    if (!runs.empty() && runs.back().texture == texture) ++runs.back().count;
+    else runs.push_back(Run{ texture, sprite, 1 });
+}
+
+SpriteBatch::Quad SpriteBatch::MakeQuad(size_t texture, Rect dst, Rect src) noexcept
+{
+    // The index is read as an unsigned integer attribute, so its bits are stored rather than its value
+    const float t = std::bit_cast<float>(static_cast<uint32_t>(texture));
+
+    return {
+        dst.x,         dst.y,         0.0f, src.x,         src.y,         t,
+        dst.x + dst.w, dst.y,         0.0f, src.x + src.w, src.y,         t,
+        dst.x + dst.w, dst.y + dst.h, 0.0f, src.x + src.w, src.y + src.h, t,
+        dst.x,         dst.y + dst.h, 0.0f, src.x,         src.y + src.h, t
+    };
+}
+
+void SpriteBatch::BindIndices(BindCache& binds) const noexcept
+{
+    binds.BindIndexBuffer(indices.GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
+}
+
+void SpriteBatch::DrawQuads(VkCommandBuffer command_buffer, uint32_t first, uint32_t count) noexcept
+{
+    // Every quad uses the same 6 indices relative to its first vertex, so the draws differ only by their vertex offset
+    for (uint32_t end = first + count; first < end; first += MAX_SPRITES_PER_DRAW) {
+        const uint32_t n = std::min(MAX_SPRITES_PER_DRAW, end - first);
+        vkCmdDrawIndexed(command_buffer, n * 6, 1, 0, static_cast<int32_t>(first * 4), 0);
+    }
+}
+
+void SpriteBatch::FlushBindless(BindCache& binds, RingBuffer& geometry, VkPipeline pipeline, VkPipelineLayout layout,
+    VkDescriptorSet textures)
+{
+    if (runs.empty()) return;
+
+    const auto range = geometry.Push(vertices.data(), vertices.size() * sizeof(float), sizeof(float));
+
+    binds.BindPipeline(pipeline);
+    binds.BindDescriptorSet(layout, 0, textures);
+    binds.BindVertexBuffer(0, range.buffer, range.offset);
+    BindIndices(binds);
+
+    DrawQuads(binds.Get(), 0, static_cast<uint32_t>(vertices.size() / (4 * FLOATS_PER_VERTEX)));
+
+    Clear();
+}
+
+void SpriteBatch::Clear() noexcept
+{
+    vertices.clear();
+    runs.clear();
+}
+}
\ No newline at end of file
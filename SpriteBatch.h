@@ -0,0 +1,121 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+#include <vector>
+#include <concepts>
+#include <array>
+#include "vulkan/vulkan.h"
+#include "RenderData.h"
+#include "Buffer.h"
+#include "RingBuffer.h"
+#include "BindCache.h"
+
+namespace VKKit {
+class Device;
+
+// Accumulates textured quads on the CPU and draws them with one draw call per run of consecutive sprites that share a texture, or with one
+// draw call for all of them when the textures are bindless. Sprites are drawn in the order they were added, so the batch has to be flushed
+// before anything else is drawn on top of them.
+class SpriteBatch {
+public:
+    static constexpr uint32_t MAX_SPRITES_PER_DRAW = 8192; // Longer runs are split into several draws
+    static constexpr size_t FLOATS_PER_VERTEX = 6;         // Position (x, y, z), texture coordinates (u, v), texture index (as uint32_t bits)
+
+    // The vertices of one sprite
+    using Quad = std::array<float, 4 * FLOATS_PER_VERTEX>;
+
+    SpriteBatch() = default;
+
+    /**
+     * @brief Create a sprite batch. The shared quad index buffer is created immediately.
+     *
+     * @param physical_device The physical device used
+     * @param device The logical device used
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    SpriteBatch(VkPhysicalDevice physical_device, const Device& device);
+
+    /**
+     * @brief Queue a sprite
+     * @param texture The index of the sprite's texture
+     * @param dst Where to draw the sprite (in normalized Vulkan coordinates)
+     * @param src The part of the texture to draw (in texture coordinates)
+     */
+    void Add(size_t texture, Rect dst, Rect src = { 0.0f, 0.0f, 1.0f, 1.0f });
+
+    // Build the vertices of a sprite drawn at dst from the src part of its texture
+    static Quad MakeQuad(size_t texture, Rect dst, Rect src = { 0.0f, 0.0f, 1.0f, 1.0f }) noexcept;
+
+    // Bind the shared quad index buffer. Every quad's indices are relative to its first vertex.
+    void BindIndices(BindCache& binds) const noexcept;
+
+    // Draw count quads starting at quad first of the bound vertex buffer. The index buffer must have been bound with BindIndices.
+    static void DrawQuads(VkCommandBuffer command_buffer, uint32_t first, uint32_t count) noexcept;
+
+    bool Empty() const noexcept { return runs.empty(); }
+
+    /**
+     * @brief Draw every queued sprite and empty the batch
+     *
+     * @param binds The bind cache of the command buffer to record to. It must have a render pass that the pipeline is compatible with
+     *              active.
+     * @param geometry The ring buffer the vertices are written to. It must not be reset before the command buffer has finished executing.
+     * @param pipeline The pipeline to draw with. Its first descriptor set is the texture's.
+     * @param layout The layout of pipeline
+     * @param get_texture_set Called with a texture index, returns the descriptor set of the texture
+     *
+     * @throw std::runtime_error with error information if the ring buffer can't grow
+     */
+    template<std::invocable<size_t> GetTextureSet>
+    void Flush(BindCache& binds, RingBuffer& geometry, VkPipeline pipeline, VkPipelineLayout layout, GetTextureSet&& get_texture_set)
+    {
+        if (runs.empty()) return;
+
+        const auto range = geometry.Push(vertices.data(), vertices.size() * sizeof(float), sizeof(float));
+
+        binds.BindPipeline(pipeline);
+        binds.BindVertexBuffer(0, range.buffer, range.offset);
+        BindIndices(binds);
+
+        for (const Run& run : runs) {
+            binds.BindDescriptorSet(layout, 0, get_texture_set(run.texture));
+            DrawQuads(binds.Get(), run.first, run.count);
+        }
+
+        Clear();
+    }
+
+    /**
+     * @brief Draw every queued sprite with one draw call and empty the batch. The shaders pick each sprite's texture from the texture
+     *        array by the index in its vertices.
+     *
+     * @param binds The bind cache of the command buffer to record to. It must have a render pass that the pipeline is compatible with
+     *              active.
+     * @param geometry The ring buffer the vertices are written to. It must not be reset before the command buffer has finished executing.
+     * @param pipeline The pipeline to draw with. Its first descriptor set is the texture array.
+     * @param layout The layout of pipeline
+     * @param textures The descriptor set of the texture array
+     *
+     * @throw std::runtime_error with error information if the ring buffer can't grow
+     */
+    void FlushBindless(BindCache& binds, RingBuffer& geometry, VkPipeline pipeline, VkPipelineLayout layout, VkDescriptorSet textures);
+
+    // Drop every queued sprite without drawing
+    void Clear() noexcept;
+
+private:
+    // Consecutive sprites that share a texture
+    struct Run {
+        size_t texture;
+        uint32_t first; // Index of the run's first sprite
+        uint32_t count;
+    };
+
+    std::vector<float> vertices;
+    std::vector<Run> runs;
+    Buffer indices;
+};
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include <bit>
+#include "StagingPool.h"
+#include "MemoryAllocator.h"
+
+namespace VKKit {
+// The smallest bucket a buffer of this size fits in
+static size_t GetBucket(VkDeviceSize size) noexcept
+{
+    const VkDeviceSize min_buckets = (size + StagingPool::MIN_BUCKET_SIZE - 1) / StagingPool::MIN_BUCKET_SIZE;
+    return std::countr_zero(std::bit_ceil(std::max<VkDeviceSize>(min_buckets, 1)));
+}
+
+StagingPool::StagingPool(VkDevice device, MemoryAllocator& allocator, VkDeviceSize max_cached_bytes) :
+    device{ device }, allocator{ &allocator }, max_cached_bytes{ max_cached_bytes }, cached_bytes{ 0 }
+{}
+
+Buffer StagingPool::Acquire(VkDeviceSize size)
+{
+    if (size > MAX_BUCKET_SIZE) return Buffer(device, *allocator, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::UPLOAD);
+
+    const size_t bucket = GetBucket(size);
+
+    {
+        std::scoped_lock lock(mutex);
+
+        auto& free_buffers = buckets[bucket];
+        if (!free_buffers.empty()) {
+            Buffer buffer = std::move(free_buffers.back());
+            free_buffers.pop_back();
+            cached_bytes -= buffer.GetSize();
+            return buffer;
+        }
+    }
+
+    return Buffer(device, *allocator, MIN_BUCKET_SIZE << bucket, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, MemoryUsage::UPLOAD);
+}
+
+void StagingPool::Release(Buffer buffer)
+{
+    const VkDeviceSize size = buffer.GetSize();
+    if (size < MIN_BUCKET_SIZE || size > MAX_BUCKET_SIZE || !std::has_single_bit(size)) return;
+
+    std::scoped_lock lock(mutex);
+    if (cached_bytes + size > max_cached_bytes) return;
+
+    cached_bytes += size;
+    buckets[GetBucket(size)].push_back(std::move(buffer));
+}
+
+void StagingPool::Trim()
+{
+    std::scoped_lock lock(mutex);
+
+    for (auto& bucket : buckets) bucket.clear();
+    cached_bytes = 0;
+}
+
+VkDeviceSize StagingPool::GetCachedBytes() const
+{
+    std::scoped_lock lock(mutex);
+    return cached_bytes;
+}
+}
\ No newline at end of file
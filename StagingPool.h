@@ -0,0 +1,68 @@
+#ifndef STAGINGPOOL_H
+#define STAGINGPOOL_H
+
+#include <array>
+#include <bit>
+#include <vector>
+#include <mutex>
+#include "vulkan/vulkan.h"
+#include "Buffer.h"
+
+namespace VKKit {
+class MemoryAllocator;
+
+// A cache of host visible staging buffers, bucketed by power of two size classes. Uploads acquire a buffer from the pool and release it
+// once the GPU has finished reading from it, so loading many assets doesn't create and destroy a staging buffer for each of them.
+// All member functions are thread safe.
+class StagingPool {
+public:
+    static constexpr VkDeviceSize MIN_BUCKET_SIZE = 4ull * 1024;
+    static constexpr VkDeviceSize MAX_BUCKET_SIZE = 64ull * 1024 * 1024; // Bigger requests get a buffer of their own, which isn't cached
+    static constexpr VkDeviceSize DEFAULT_MAX_CACHED_BYTES = 64ull * 1024 * 1024;
+
+    /**
+     * @brief Construct a staging pool. No buffers are created until the first call to Acquire().
+     *
+     * @param device The logical device used
+     * @param allocator The allocator the staging buffers will be allocated from
+     * @param max_cached_bytes How many bytes of free buffers the pool may hold on to. Buffers released past this limit are destroyed.
+     */
+    StagingPool(VkDevice device, MemoryAllocator& allocator, VkDeviceSize max_cached_bytes = DEFAULT_MAX_CACHED_BYTES);
+
+    StagingPool(const StagingPool&) = delete;
+    StagingPool& operator=(const StagingPool&) = delete;
+    StagingPool(StagingPool&&) = delete;
+    StagingPool& operator=(StagingPool&&) = delete;
+
+    /**
+     * @brief Get a mapped staging buffer of at least size bytes
+     * @throw std::runtime_error with error information on failure
+     */
+    Buffer Acquire(VkDeviceSize size);
+
+    /**
+     * @brief Give a buffer acquired from the pool back to it. The GPU must have finished using the buffer. Buffers too big to be
+     *        cached, or released while the pool is full, are destroyed.
+     */
+    void Release(Buffer buffer);
+
+    // Destroy every cached buffer
+    void Trim();
+
+    // The total size of the free buffers held by the pool
+    VkDeviceSize GetCachedBytes() const;
+
+private:
+    static constexpr size_t BUCKET_COUNT = std::countr_zero(MAX_BUCKET_SIZE / MIN_BUCKET_SIZE) + 1;
+
+    VkDevice device;
+    MemoryAllocator* allocator;
+    VkDeviceSize max_cached_bytes;
+    VkDeviceSize cached_bytes;
+    std::array<std::vector<Buffer>, BUCKET_COUNT> buckets;
+
+    mutable std::mutex mutex;
+};
+}
+
+#endif
\ No newline at end of file
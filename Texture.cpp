@@ -5,9 +5,9 @@
 #include "Texture.h"
 #include "Buffer.h"
 #include "VkResultString.h"
-#include "CommandBuffer.h"
 #include "Device.h"
-#include "CommandPool.h"
+#include "UploadQueue.h"
+#include "MemoryAllocator.h"
 
 namespace {
 class ImageData {
@@ -78,12 +78,8 @@ private:
 }
 
 namespace VKKit {
-static void CopyBufferToImage(const Device& device, const CommandPool& command_pool, const Buffer& buffer, const Image& image,
-    uint32_t width, uint32_t height, VkQueue graphics_queue)
+static void CopyBufferToImage(VkCommandBuffer command_buffer, const Buffer& buffer, const Image& image, uint32_t width, uint32_t height)
 {
-    const CommandBuffer command_buffer(device, command_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-    command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
     const VkBufferImageCopy region = {
         .bufferOffset = 0,
         .bufferRowLength = 0,
@@ -100,18 +96,12 @@ static void CopyBufferToImage(const Device& device, const CommandPool& command_p
         .imageExtent = { width, height, 1 }
     };
 
-    vkCmdCopyBufferToImage(command_buffer.GetBuffer(), buffer.GetBuffer(), image.Get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
-
-    command_buffer.End();
-    command_buffer.Submit(graphics_queue, true);
+    vkCmdCopyBufferToImage(command_buffer, buffer.GetBuffer(), image.Get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
 }
 
-static void TransitionImageLayout(const Device& device, const CommandPool& command_pool, const Image& image, VkFormat format,
-    VkImageLayout old_layout, VkImageLayout new_layout, VkQueue graphics_queue, uint32_t mip_levels)
+static void TransitionImageLayout(VkCommandBuffer command_buffer, const Image& image, VkImageLayout old_layout, VkImageLayout new_layout,
+    uint32_t mip_levels)
 {
-    CommandBuffer command_buffer(device, command_pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-    command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
     VkImageMemoryBarrier barrier = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .srcAccessMask = 0,
@@ -150,23 +140,19 @@ static void TransitionImageLayout(const Device& device, const CommandPool& comma
     else
         throw std::invalid_argument("Unsupported layout transition");
 
-    vkCmdPipelineBarrier(command_buffer.GetBuffer(), source_stage, destination_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
-
-    command_buffer.End();
-    command_buffer.Submit(graphics_queue, true);
+    vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 }
 
-static void GenerateMipmaps(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, VkQueue graphics_queue, const Image& image,
-    VkFormat image_format, int32_t width, int32_t height, uint32_t mip_levels)
+static void CheckMipmapSupport(VkPhysicalDevice physical_device, VkFormat image_format)
 {
     VkFormatProperties format_properties;
     vkGetPhysicalDeviceFormatProperties(physical_device, image_format, &format_properties);
     if (!(format_properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT))
         throw std::runtime_error("Texture image format doesn't support linear blitting");
+}
 
-    const CommandBuffer command_buffer(device, pool, VK_COMMAND_BUFFER_LEVEL_PRIMARY);
-    command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
-
+static void GenerateMipmaps(VkCommandBuffer command_buffer, const Image& image, int32_t width, int32_t height, uint32_t mip_levels)
+{
     VkImageMemoryBarrier barrier = {
         .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
@@ -186,7 +172,7 @@ static void GenerateMipmaps(VkPhysicalDevice physical_device, const Device& devi
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
         barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
 
-        vkCmdPipelineBarrier(command_buffer.GetBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
             0, 0, nullptr, 0, nullptr, 1, &barrier);
 
         const VkImageBlit blit = {
@@ -212,7 +198,7 @@ static void GenerateMipmaps(VkPhysicalDevice physical_device, const Device& devi
             }
         };
 
-        vkCmdBlitImage(command_buffer.GetBuffer(), image.Get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image.Get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        vkCmdBlitImage(command_buffer, image.Get(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image.Get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
             1, &blit, VK_FILTER_LINEAR);
 
         barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
@@ -220,7 +206,7 @@ static void GenerateMipmaps(VkPhysicalDevice physical_device, const Device& devi
         barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
         barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-        vkCmdPipelineBarrier(command_buffer.GetBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
 
         if (width > 1) width /= 2;
         if (height > 1) height /= 2;
@@ -232,10 +218,24 @@ static void GenerateMipmaps(VkPhysicalDevice physical_device, const Device& devi
     barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
     barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
 
-    vkCmdPipelineBarrier(command_buffer.GetBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+// Sub-allocate memory for the image from the device's allocator and bind it
+static ScopedAllocation BindImageMemory(const Device& device, const Image& image, VkImageTiling tiling, VkMemoryPropertyFlags properties,
+    MemoryCategory category)
+{
+    VkMemoryRequirements mem_requirements;
+    vkGetImageMemoryRequirements(device.Get(), image.Get(), &mem_requirements);
 
-    command_buffer.End();
-    command_buffer.Submit(graphics_queue, true);
+    MemoryAllocator& allocator = device.GetAllocator();
+    ScopedAllocation memory(allocator, allocator.Allocate(mem_requirements, properties, category,
+        tiling == VK_IMAGE_TILING_OPTIMAL ? ResourceTiling::OPTIMAL : ResourceTiling::LINEAR));
+
+    const auto bind_result = vkBindImageMemory(device.Get(), image.Get(), memory.Get().memory, memory.Get().offset);
+    if (bind_result != VK_SUCCESS) ThrowError("Failed to bind image memory.", bind_result);
+
+    return memory;
 }
 
 static uint32_t CalculateMaxMipLevels(uint32_t width, uint32_t height)
@@ -255,30 +255,29 @@ Texture::Texture(VkPhysicalDevice physical_device, const Device& device, const C
 
     const VkDeviceSize size = pixels.GetWidth() * pixels.GetHeight() * sizeof(int);
 
-    const Buffer staging_buffer(physical_device, device, size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+    Buffer staging_buffer = device.GetUploadQueue().AcquireStaging(size);
 
-    void* data;
-    vkMapMemory(device.Get(), staging_buffer.GetMemory(), 0, size, 0, &data);
-    memcpy(data, pixels.GetPixels(), size);
-    vkUnmapMemory(device.Get(), staging_buffer.GetMemory());
+    memcpy(staging_buffer.GetMapped(), pixels.GetPixels(), size);
 
     if (mipmap_levels == 0) mipmap_levels = CalculateMaxMipLevels(width, height);
 
     this->texture = Image(device, 0, VK_IMAGE_TYPE_2D, format, { static_cast<uint32_t>(pixels.GetWidth()), static_cast<uint32_t>(pixels.GetHeight()), 1 }, mipmap_levels,
         1, samples, tiling, usage, VK_SHARING_MODE_EXCLUSIVE, 0, nullptr, VK_IMAGE_LAYOUT_UNDEFINED);
         
-    VkMemoryRequirements mem_requirements;
-    vkGetImageMemoryRequirements(device.Get(), texture.Get(), &mem_requirements);
+    this->memory = BindImageMemory(device, texture, tiling, properties, MemoryCategory::TEXTURE);
 
-    this->memory = DeviceMemory(device, mem_requirements.size, FindMemoryType(physical_device, mem_requirements.memoryTypeBits, properties));
-    vkBindImageMemory(device.Get(), texture.Get(), memory.Get(), 0);
+    CheckMipmapSupport(physical_device, format);
+    UploadQueue& upload_queue = device.GetUploadQueue();
+    upload_queue.Record([&](VkCommandBuffer command_buffer) {
+        TransitionImageLayout(command_buffer, texture, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipmap_levels);
+        CopyBufferToImage(command_buffer, staging_buffer, texture, width, height);
+    }, std::move(staging_buffer));
 
-    TransitionImageLayout(device, pool, texture, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, device.GetGraphicsQueue(), mipmap_levels);
-    CopyBufferToImage(device, pool, staging_buffer, texture, static_cast<uint32_t>(width),
-        static_cast<uint32_t>(height), device.GetGraphicsQueue());
-    GenerateMipmaps(physical_device, device, pool, device.GetGraphicsQueue(), texture, format, width, height, mipmap_levels);
+    // Blits need a graphics queue, so the mip chain is generated after the image has been handed over from the transfer queue
+    upload_queue.TransferOwnership(texture.Get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, { VK_IMAGE_ASPECT_COLOR_BIT, 0, mipmap_levels, 0, 1 });
+    upload_queue.RecordGraphics([&](VkCommandBuffer command_buffer) {
+        GenerateMipmaps(command_buffer, texture, width, height, mipmap_levels);
+    });
 
     this->view = ImageView(device, 0, texture.Get(), VK_IMAGE_VIEW_TYPE_2D, format, VkComponentMapping{}, { aspect, 0, mipmap_levels, 0, 1 });
 }
@@ -293,44 +292,46 @@ Texture::Texture(VkPhysicalDevice physical_device, const Device& device, const C
     texture = Image(device, VkImageCreateFlags{}, VK_IMAGE_TYPE_2D, format, VkExtent3D{ width, height, 1 }, mipmap_levels, 1, samples, tiling, usage,
         VK_SHARING_MODE_EXCLUSIVE, 0, nullptr, VK_IMAGE_LAYOUT_UNDEFINED);
 
-    VkMemoryRequirements mem_requirements;
-    vkGetImageMemoryRequirements(device.Get(), texture.Get(), &mem_requirements);
-
-    memory = DeviceMemory(device, mem_requirements.size, FindMemoryType(physical_device, mem_requirements.memoryTypeBits, properties));
-    
-    vkBindImageMemory(device.Get(), texture.Get(), memory.Get(), 0);
+    constexpr VkImageUsageFlags attachment_usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT |
+        VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT;
+    memory = BindImageMemory(device, texture, tiling, properties, usage & attachment_usage ? MemoryCategory::ATTACHMENT : MemoryCategory::TEXTURE);
 
     view = ImageView(device, VkImageViewCreateFlags{}, texture.Get(), VK_IMAGE_VIEW_TYPE_2D, format, VkComponentMapping{}, { aspect, 0, mipmap_levels, 0, 1 });
 }
 
 Texture::Texture(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, VkFormat format, uint32_t width, uint32_t height,
-    ut::rspan<const unsigned char> image_data, VkImageTiling tiling, VkSampleCountFlagBits samples, uint32_t mips)
+    ut::rspan<const unsigned char> image_data, VkImageTiling tiling, VkSampleCountFlagBits samples, uint32_t mips, MemoryCategory category) :
+    width{ width }, height{ height }
 {
     if (mips == 0) mips = CalculateMaxMipLevels(width, height);
 
     // const VkDeviceSize size = width * height * sizeof(uint32_t); // Each texel is sizeof(uint32_t) big
     const VkDeviceSize size = image_data.size_bytes();
 
-    const Buffer staging = CreateStagingBuffer(physical_device, device.Get(), size);
+    Buffer staging = device.GetUploadQueue().AcquireStaging(size);
 
-    void* data;
-    vkMapMemory(device.Get(), staging.GetMemory(), 0, size, 0, &data);
-    memcpy(data, image_data.data(), size);
-    vkUnmapMemory(device.Get(), staging.GetMemory());
+    memcpy(staging.GetMapped(), image_data.data(), size);
 
-    this->texture = Image(device, 0, VK_IMAGE_TYPE_2D, format, { width, height, 1 }, mips, 1, samples, tiling, VK_IMAGE_USAGE_TRANSFER_DST_BIT |
-        VK_IMAGE_USAGE_SAMPLED_BIT, VK_SHARING_MODE_EXCLUSIVE, 0, nullptr, VK_IMAGE_LAYOUT_UNDEFINED);
-
-    VkMemoryRequirements mem_requirements;
-    vkGetImageMemoryRequirements(device.Get(), texture.Get(), &mem_requirements);
+    mipmap_levels = mips;
 
-    this->memory = DeviceMemory(device, mem_requirements.size, FindMemoryType(physical_device, mem_requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
-    vkBindImageMemory(device.Get(), texture.Get(), memory.Get(), 0);
-
-    TransitionImageLayout(device, pool, texture, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        device.GetGraphicsQueue(), mips);
-    CopyBufferToImage(device, pool, staging, texture, width, height, device.GetGraphicsQueue());
-    GenerateMipmaps(physical_device, device, pool, device.GetGraphicsQueue(), texture, format, width, height, mips);
+    // The mip chain is blitted from the image itself
+    this->texture = Image(device, 0, VK_IMAGE_TYPE_2D, format, { width, height, 1 }, mips, 1, samples, tiling, VK_IMAGE_USAGE_TRANSFER_DST_BIT |
+        VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_SHARING_MODE_EXCLUSIVE, 0, nullptr, VK_IMAGE_LAYOUT_UNDEFINED);
+
+    this->memory = BindImageMemory(device, texture, tiling, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, category);
+
+    CheckMipmapSupport(physical_device, format);
+    UploadQueue& upload_queue = device.GetUploadQueue();
+    upload_queue.Record([&](VkCommandBuffer command_buffer) {
+        TransitionImageLayout(command_buffer, texture, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mips);
+        CopyBufferToImage(command_buffer, staging, texture, width, height);
+    }, std::move(staging));
+
+    // Blits need a graphics queue, so the mip chain is generated after the image has been handed over from the transfer queue
+    upload_queue.TransferOwnership(texture.Get(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, { VK_IMAGE_ASPECT_COLOR_BIT, 0, mips, 0, 1 });
+    upload_queue.RecordGraphics([&](VkCommandBuffer command_buffer) {
+        GenerateMipmaps(command_buffer, texture, width, height, mips);
+    });
 
     this->view = ImageView(device, 0, texture.Get(), VK_IMAGE_VIEW_TYPE_2D, format, {}, { VK_IMAGE_ASPECT_COLOR_BIT, 0, mips, 0, 1 });
 }
@@ -4,6 +4,7 @@
 #include <expected>
 #include "vulkan/vulkan.hpp"
 #include "ImageObjects.h"
+#include "MemoryAllocator.h"
 #include "rspan.h"
 
 namespace VKKit {
@@ -41,11 +42,17 @@ public:
         VkImageAspectFlags aspect, VkImageTiling tiling, VkSampleCountFlagBits samples, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
         uint32_t mip_levels);
 
+    /**
+     * @brief Construct a sampled texture from raw texel data
+     * @param category What the texture is used for, for memory accounting
+     */
     Texture(VkPhysicalDevice physical_device, const Device& device, const CommandPool& pool, VkFormat format, uint32_t width, uint32_t height,
-        ut::rspan<const unsigned char> image_data, VkImageTiling tiling, VkSampleCountFlagBits samples, uint32_t mips);
+        ut::rspan<const unsigned char> image_data, VkImageTiling tiling, VkSampleCountFlagBits samples, uint32_t mips,
+        MemoryCategory category = MemoryCategory::TEXTURE);
 
     VkImage GetTexture() const noexcept { return texture.Get(); }
-    VkDeviceMemory GetMemory() const noexcept { return memory.Get(); }
+    VkDeviceMemory GetMemory() const noexcept { return memory.Get().memory; }
+    VkDeviceSize GetMemoryOffset() const noexcept { return memory.Get().offset; }
     VkImageView GetView() const noexcept { return view.Get(); }
 
     int GetWidth() const noexcept { return width; }
@@ -54,8 +61,8 @@ public:
     uint32_t GetMipmaps() const noexcept { return mipmap_levels; }
 
 private:
+    ScopedAllocation memory; // Declared first so the image is destroyed before its memory is handed out again
     Image texture;
-    DeviceMemory memory;
     ImageView view;
     uint32_t width, height, channels;
     uint32_t mipmap_levels;
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <cstring>
+#include "stb_image.h"
+#include "TextureAtlas.h"
+
+namespace VKKit {
+SkylinePacker::SkylinePacker(uint32_t width, uint32_t height) :
+    width{ width }, height{ height }, skyline{ Segment{ 0, 0, width } }
+{}
+
+std::optional<uint32_t> SkylinePacker::Fit(size_t i, uint32_t width, uint32_t height) const noexcept
+{
+    const uint32_t x = skyline[i].x;
+    if (x + width > this->width) return std::nullopt;
+
+    // The rectangle rests on the highest segment under it
+    uint32_t y = 0;
+    for (uint32_t covered = 0; covered < width; covered += skyline[i++].width) {
+        y = std::max(y, skyline[i].y);
+        if (y + height > this->height) return std::nullopt;
+    }
+
+    return y;
+}
+
+std::optional<SkylinePacker::Position> SkylinePacker::Insert(uint32_t width, uint32_t height)
+{
+    size_t best = skyline.size();
+    uint32_t best_y = 0;
+
+    for (size_t i = 0; i < skyline.size(); ++i) {
+        const auto y = Fit(i, width, height);
+        if (y && (best == skyline.size() || *y < best_y)) {
+            best = i;
+            best_y = *y;
+        }
+    }
+
+    if (best == skyline.size()) return std::nullopt;
+
+    const Position position = { skyline[best].x, best_y };
+
+    // The rectangle's top becomes a segment, and the segments it covers are cut off or removed
+    skyline.insert(skyline.begin() + best, Segment{ position.x, best_y + height, width });
+
+    const uint32_t right = position.x + width;
+    for (size_t i = best + 1; i < skyline.size() && skyline[i].x < right;) {
+        const uint32_t end = skyline[i].x + skyline[i].width;
+        if (end <= right) {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+
+        skyline[i].width = end - right;
+        skyline[i].x = right;
+        break;
+    }
+
+    // Neighbours at the same height are one segment
+    for (size_t i = 0; i + 1 < skyline.size();) {
+        if (skyline[i].y == skyline[i + 1].y) {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else ++i;
+    }
+
+    return position;
+}
+
+// Round up to a multiple of the padding, so every image starts on a texel of the smallest mip level
+static uint32_t AlignToPadding(uint32_t n) noexcept
+{
+    return (n + AtlasPages::PADDING - 1) / AtlasPages::PADDING * AtlasPages::PADDING;
+}
+
+// Copy an image into a page at x, y and extend its edge texels over the padding around it, so filtering and the smaller mip levels
+// sample the image's own colours at its border instead of its neighbours'
+static void Blit(std::vector<unsigned char>& page, uint32_t size, const unsigned char* image, uint32_t width, uint32_t height, uint32_t x,
+    uint32_t y)
+{
+    constexpr uint32_t p = AtlasPages::PADDING;
+
+    for (uint32_t row = 0; row < height + 2 * p; ++row) {
+        const uint32_t src_row = std::clamp(row, p, height + p - 1) - p;
+        unsigned char* dst = page.data() + ((y + row) * size + x) * 4;
+        const unsigned char* src = image + src_row * width * 4;
+
+        for (uint32_t column = 0; column < p; ++column) memcpy(dst + column * 4, src, 4);
+        memcpy(dst + p * 4, src, width * 4);
+        for (uint32_t column = 0; column < p; ++column) memcpy(dst + (p + width + column) * 4, src + (width - 1) * 4, 4);
+    }
+}
+
+AtlasPages AtlasPages::Pack(std::span<const std::string_view> paths, uint32_t size)
+{
+    struct Image {
+        std::unique_ptr<stbi_uc, decltype(&stbi_image_free)> pixels;
+        uint32_t width, height;
+    };
+
+    std::vector<Image> images;
+    images.reserve(paths.size());
+
+    for (const auto path : paths) {
+        int w, h, channels;
+        stbi_uc* pixels = stbi_load(std::string(path).c_str(), &w, &h, &channels, STBI_rgb_alpha);
+        if (!pixels) throw std::runtime_error("Failed to load atlas image " + std::string(path) + ". Error: " + stbi_failure_reason());
+
+        images.push_back(Image{ { pixels, &stbi_image_free }, static_cast<uint32_t>(w), static_cast<uint32_t>(h) });
+
+        if (AlignToPadding(images.back().width + 2 * PADDING) > size || AlignToPadding(images.back().height + 2 * PADDING) > size)
+            throw std::runtime_error("Atlas image " + std::string(path) + " is larger than an atlas page");
+    }
+
+    // Packing the tallest images first leaves the flattest skyline
+    std::vector<size_t> order(images.size());
+    std::iota(order.begin(), order.end(), size_t{ 0 });
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return images[a].height > images[b].height; });
+
+    AtlasPages atlas = { .size = size, .pages = {}, .regions = std::vector<std::pair<size_t, Rect>>(images.size()) };
+    std::vector<SkylinePacker> packers;
+
+    for (const size_t i : order) {
+        const Image& image = images[i];
+        const uint32_t w = AlignToPadding(image.width + 2 * PADDING), h = AlignToPadding(image.height + 2 * PADDING);
+
+        // Earlier pages may still have room for small images
+        std::optional<SkylinePacker::Position> position;
+        size_t page = 0;
+        for (; page < packers.size() && !position; ++page) position = packers[page].Insert(w, h);
+
+        if (!position) {
+            packers.emplace_back(size, size);
+            atlas.pages.emplace_back(static_cast<size_t>(size) * size * 4, 0);
+            position = packers.back().Insert(w, h);
+            page = packers.size();
+        }
+
+        --page;
+        Blit(atlas.pages[page], size, image.pixels.get(), image.width, image.height, position->x, position->y);
+
+        const float texel = 1.0f / static_cast<float>(size);
+        atlas.regions[i] = { page, Rect{ (position->x + PADDING) * texel, (position->y + PADDING) * texel, image.width * texel,
+            image.height * texel } };
+    }
+
+    return atlas;
+}
+}
\ No newline at end of file
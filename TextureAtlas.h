@@ -0,0 +1,58 @@
+#ifndef TEXTUREATLAS_H
+#define TEXTUREATLAS_H
+
+#include <vector>
+#include <span>
+#include <optional>
+#include <string_view>
+#include <cstdint>
+#include "RenderData.h"
+
+namespace VKKit {
+// Packs rectangles into a fixed size area with the skyline bottom-left heuristic. The skyline is the top edge of everything packed so
+// far, and every rectangle goes where its top ends up lowest.
+class SkylinePacker {
+public:
+    struct Position {
+        uint32_t x, y;
+    };
+
+    SkylinePacker(uint32_t width, uint32_t height);
+
+    // Find a place for a width x height rectangle and reserve it. Returns nothing if the rectangle doesn't fit anymore.
+    std::optional<Position> Insert(uint32_t width, uint32_t height);
+
+private:
+    // A horizontal segment of the skyline, from x to x + width at height y
+    struct Segment {
+        uint32_t x, y, width;
+    };
+
+    uint32_t width, height;
+    std::vector<Segment> skyline;
+
+    // The height a rectangle placed at the start of segment i would rest at, or nothing if it would stick out of the area
+    std::optional<uint32_t> Fit(size_t i, uint32_t width, uint32_t height) const noexcept;
+};
+
+// Images packed into square pages of RGBA texels, ready to be created as textures
+struct AtlasPages {
+    static constexpr uint32_t PADDING = 4;    // Texels around every image, filled with its edge texels
+    static constexpr uint32_t MIP_LEVELS = 3; // Mip levels that the padding keeps the images apart in
+
+    uint32_t size;                                  // The width and height of every page
+    std::vector<std::vector<unsigned char>> pages;  // The texels of each page
+    std::vector<std::pair<size_t, Rect>> regions;   // The page and texture coordinates of each image, in the order they were given
+
+    /**
+     * @brief Load images and pack them into as few pages as possible
+     * @param paths The files of the images
+     * @param size The width and height of the pages
+     *
+     * @throw std::runtime_error if an image can't be loaded or doesn't fit on a page
+     */
+    static AtlasPages Pack(std::span<const std::string_view> paths, uint32_t size);
+};
+}
+
+#endif
\ No newline at end of file
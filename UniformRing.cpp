@@ -0,0 +1,35 @@
+#include <cstring>
+#include <stdexcept>
+#include "UniformRing.h"
+#include "PhysicalDevice.h"
+#include "Device.h"
+
+namespace VKKit {
+UniformRing::UniformRing() noexcept :
+    element_size{ 0 }, stride{ 0 }, capacity{ 0 }, count{ 0 }
+{}
+
+UniformRing::UniformRing(VkPhysicalDevice physical_device, const Device& device, VkDeviceSize element_size, uint32_t capacity) :
+    element_size{ element_size }, capacity{ capacity }, count{ 0 }
+{
+    const VkDeviceSize alignment = GetPhysicalDeviceProperties(physical_device).limits.minUniformBufferOffsetAlignment;
+    stride = (element_size + alignment - 1) / alignment * alignment;
+
+    buffer = Buffer(device, stride * capacity, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, MemoryUsage::DYNAMIC);
+    last.resize(element_size);
+}
+
+uint32_t UniformRing::Push(const void* data)
+{
+    char* const mapped = static_cast<char*>(buffer.GetMapped());
+
+    if (count > 0 && memcmp(last.data(), data, element_size) == 0)
+        return static_cast<uint32_t>((count - 1) * stride);
+
+    if (count == capacity) throw std::runtime_error("Uniform ring is full. Too many different uniforms were used in one frame.");
+
+    memcpy(mapped + count * stride, data, element_size);
+    memcpy(last.data(), data, element_size);
+    return static_cast<uint32_t>(count++ * stride);
+}
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#ifndef UNIFORMRING_H
+#define UNIFORMRING_H
+
+#include <vector>
+#include <cstdint>
+#include "vulkan/vulkan.h"
+#include "Buffer.h"
+
+namespace VKKit {
+class Device;
+
+// A fixed size, persistently mapped uniform buffer that is filled with one element per draw and read through a dynamic uniform buffer
+// descriptor. Unlike RingBuffer it never grows, because descriptor sets point at one buffer. Consecutive pushes of the same data share
+// a slot.
+class UniformRing {
+public:
+    static constexpr uint32_t DEFAULT_CAPACITY = 1024;
+
+    UniformRing() noexcept;
+
+    /**
+     * @brief Create a uniform ring
+     *
+     * @param physical_device The physical device used, whose uniform buffer offset alignment the slots are aligned to
+     * @param device The logical device used
+     * @param element_size The size of one element
+     * @param capacity The number of elements that can be pushed between resets
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    UniformRing(VkPhysicalDevice physical_device, const Device& device, VkDeviceSize element_size, uint32_t capacity = DEFAULT_CAPACITY);
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+    UniformRing(UniformRing&&) noexcept = default;
+    UniformRing& operator=(UniformRing&&) noexcept = default;
+
+    /**
+     * @brief Copy an element to the ring
+     * @param data The element, element_size bytes long
+     * @return The dynamic offset to bind the descriptor with
+     *
+     * @throw std::runtime_error if the ring is full
+     */
+    uint32_t Push(const void* data);
+
+    // Start writing from the beginning again. The GPU must not be reading anything written since the last reset.
+    void Reset() noexcept { count = 0; }
+
+    const Buffer& GetBuffer() const noexcept { return buffer; }
+
+    // The size of one element, which is the range of the descriptor
+    VkDeviceSize GetElementSize() const noexcept { return element_size; }
+
+private:
+    Buffer buffer;
+    VkDeviceSize element_size;
+    VkDeviceSize stride;
+    uint32_t capacity;
+    uint32_t count;
+    std::vector<char> last; // The last pushed element. The mapping may be write-combined memory, which is slow to read back.
+};
+}
+
+#endif
\ No newline at end of file
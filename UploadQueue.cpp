@@ -0,0 +1,301 @@
+#include "UploadQueue.h"
+#include "MemoryAllocator.h"
+#include "VkResultString.h"
+
+namespace VKKit {
+UploadQueue::UploadQueue(VkDevice device, MemoryAllocator& allocator, uint32_t transfer_family, VkQueue transfer_queue, uint32_t graphics_family,
+    VkQueue graphics_queue) :
+    device{ device }, allocator{ &allocator }, transfer_family{ transfer_family }, graphics_family{ graphics_family },
+    transfer_queue{ transfer_queue }, graphics_queue{ graphics_queue },
+    transfer_pool{ device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, transfer_family },
+    staging_pool{ device, allocator }, pending{}, recording{ false }, last_submitted{ 0 }, last_completed{ 0 },
+    in_flight_staging_bytes{ 0 }
+{
+    if (HasDedicatedTransferQueue())
+        graphics_pool = CommandPool(device, VK_COMMAND_POOL_CREATE_TRANSIENT_BIT | VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, graphics_family);
+}
+
+UploadQueue::~UploadQueue()
+{
+    for (const auto& s : in_flight) s.fence.Wait();
+}
+
+Buffer UploadQueue::AcquireStaging(VkDeviceSize size)
+{
+    {
+        std::scoped_lock lock(mutex);
+
+        CollectLocked();
+        if (pending.staging_bytes >= MAX_PENDING_STAGING_BYTES || pending.staging.size() >= MAX_PENDING_STAGING_BUFFERS) FlushLocked();
+
+        while (in_flight_staging_bytes > MAX_IN_FLIGHT_STAGING_BYTES) {
+            in_flight.front().fence.Wait();
+            CollectLocked();
+        }
+    }
+
+    // Buffers the collection released are picked up again here
+    return staging_pool.Acquire(size);
+}
+
+UploadQueue::Ticket UploadQueue::Upload(const Buffer& dst, const void* data, VkDeviceSize size, VkDeviceSize dst_offset)
+{
+    Buffer staging = AcquireStaging(size);
+    memcpy(staging.GetMapped(), data, size);
+
+    std::scoped_lock lock(mutex);
+
+    const VkBufferCopy region = {
+        .srcOffset = 0,
+        .dstOffset = dst_offset,
+        .size = size
+    };
+    CopyBufferLocked(dst, staging.GetBuffer(), region);
+
+    AddStagingLocked(std::move(staging));
+    return last_submitted + 1;
+}
+
+UploadQueue::Ticket UploadQueue::CopyBuffer(const Buffer& dst, const Buffer& src, VkDeviceSize size, VkDeviceSize dst_offset, VkDeviceSize src_offset)
+{
+    std::scoped_lock lock(mutex);
+
+    const VkBufferCopy region = {
+        .srcOffset = src_offset,
+        .dstOffset = dst_offset,
+        .size = size
+    };
+    CopyBufferLocked(dst, src.GetBuffer(), region);
+
+    return last_submitted + 1;
+}
+
+void UploadQueue::TransferOwnership(const Buffer& buffer)
+{
+    std::scoped_lock lock(mutex);
+    TransferOwnershipLocked(buffer);
+}
+
+void UploadQueue::TransferOwnership(VkImage image, VkImageLayout layout, const VkImageSubresourceRange& range)
+{
+    if (!HasDedicatedTransferQueue()) return;
+
+    std::scoped_lock lock(mutex);
+
+    VkImageMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = 0,
+        .oldLayout = layout,
+        .newLayout = layout,
+        .srcQueueFamilyIndex = transfer_family,
+        .dstQueueFamilyIndex = graphics_family,
+        .image = image,
+        .subresourceRange = range
+    };
+
+    // Release on the transfer queue...
+    vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    // ...and acquire on the graphics queue
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(pending.graphics_command_buffer.GetBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
+        0, nullptr, 1, &barrier);
+}
+
+UploadQueue::Ticket UploadQueue::Flush()
+{
+    std::scoped_lock lock(mutex);
+    FlushLocked();
+    return last_submitted;
+}
+
+void UploadQueue::Collect()
+{
+    std::scoped_lock lock(mutex);
+    CollectLocked();
+}
+
+bool UploadQueue::IsComplete(Ticket ticket)
+{
+    std::scoped_lock lock(mutex);
+    CollectLocked();
+    return ticket <= last_completed;
+}
+
+void UploadQueue::Wait(Ticket ticket)
+{
+    std::scoped_lock lock(mutex);
+    if (ticket > last_submitted) FlushLocked();
+
+    for (const auto& s : in_flight) {
+        if (s.ticket > ticket) break;
+        s.fence.Wait();
+    }
+
+    CollectLocked();
+}
+
+VkCommandBuffer UploadQueue::GetCommandBuffer()
+{
+    if (!recording) {
+        if (free_submissions.empty()) {
+            pending = Submission {
+                .command_buffer = CommandBuffer(device, transfer_pool.Get(), VK_COMMAND_BUFFER_LEVEL_PRIMARY),
+                .graphics_command_buffer = HasDedicatedTransferQueue() ? CommandBuffer(device, graphics_pool.Get(), VK_COMMAND_BUFFER_LEVEL_PRIMARY) :
+                    CommandBuffer(),
+                .transferred = HasDedicatedTransferQueue() ? Semaphore(device) : Semaphore(),
+                .fence = Fence(device, false),
+                .staging = {},
+                .staging_bytes = 0,
+                .ticket = 0
+            };
+        }
+        else {
+            pending = std::move(free_submissions.back());
+            free_submissions.pop_back();
+        }
+
+        pending.command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        if (HasDedicatedTransferQueue()) pending.graphics_command_buffer.Begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+        recording = true;
+    }
+
+    return pending.command_buffer.GetBuffer();
+}
+
+void UploadQueue::AddStagingLocked(Buffer&& staging)
+{
+    if (!staging.GetBuffer()) return;
+
+    pending.staging_bytes += staging.GetSize();
+    pending.staging.push_back(std::move(staging));
+}
+
+void UploadQueue::CopyBufferLocked(const Buffer& dst, VkBuffer src, const VkBufferCopy& region)
+{
+    if (!dst.graphics_owned) {
+        vkCmdCopyBuffer(GetCommandBuffer(), src, dst.GetBuffer(), 1, &region);
+        TransferOwnershipLocked(dst);
+        return;
+    }
+
+    // The graphics queue owns the buffer and frames submitted earlier may still be reading it. Copying on the graphics side orders the
+    // copy after them, where moving the buffer back to the transfer queue would need a release recorded on the graphics queue first.
+    GetCommandBuffer();
+    const VkCommandBuffer command_buffer = HasDedicatedTransferQueue() ? pending.graphics_command_buffer.GetBuffer() :
+        pending.command_buffer.GetBuffer();
+
+    vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+    vkCmdCopyBuffer(command_buffer, src, dst.GetBuffer(), 1, &region);
+}
+
+void UploadQueue::TransferOwnershipLocked(const Buffer& buffer)
+{
+    if (buffer.graphics_owned) return;
+    buffer.graphics_owned = true;
+    if (!HasDedicatedTransferQueue()) return;
+
+    // Buffers are always transferred whole, the graphics queue reads them in their entirety
+    VkBufferMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = 0,
+        .srcQueueFamilyIndex = transfer_family,
+        .dstQueueFamilyIndex = graphics_family,
+        .buffer = buffer.GetBuffer(),
+        .offset = 0,
+        .size = VK_WHOLE_SIZE
+    };
+
+    vkCmdPipelineBarrier(GetCommandBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(pending.graphics_command_buffer.GetBuffer(), VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr,
+        1, &barrier, 0, nullptr);
+}
+
+void UploadQueue::FlushLocked()
+{
+    if (!recording) return;
+
+    const VkCommandBuffer transfer_commands = pending.command_buffer.GetBuffer();
+    const VkCommandBuffer graphics_commands = HasDedicatedTransferQueue() ? pending.graphics_command_buffer.GetBuffer() : transfer_commands;
+
+    // Make the uploaded data visible to everything that may read it later on the graphics queue, so users of the data don't need to wait
+    const VkMemoryBarrier barrier = {
+        .sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+        .srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+        .dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT | VK_ACCESS_UNIFORM_READ_BIT | VK_ACCESS_SHADER_READ_BIT |
+            VK_ACCESS_TRANSFER_READ_BIT
+    };
+    vkCmdPipelineBarrier(graphics_commands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT |
+        VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT,
+        0, 1, &barrier, 0, nullptr, 0, nullptr);
+
+    pending.command_buffer.End();
+
+    if (HasDedicatedTransferQueue()) {
+        pending.graphics_command_buffer.End();
+
+        const VkSemaphore transferred = pending.transferred.Get();
+        const VkSubmitInfo transfer_submit = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &transfer_commands,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &transferred
+        };
+
+        const auto transfer_result = vkQueueSubmit(transfer_queue, 1, &transfer_submit, VK_NULL_HANDLE);
+        if (transfer_result != VK_SUCCESS) ThrowError("Failed to submit upload command buffer.", transfer_result);
+
+        const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        const VkSubmitInfo graphics_submit = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &transferred,
+            .pWaitDstStageMask = &wait_stage,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &graphics_commands
+        };
+
+        const auto graphics_result = vkQueueSubmit(graphics_queue, 1, &graphics_submit, pending.fence.Get());
+        if (graphics_result != VK_SUCCESS) ThrowError("Failed to submit upload command buffer.", graphics_result);
+    }
+    else {
+        const VkSubmitInfo submit_info = {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &transfer_commands
+        };
+
+        const auto result = vkQueueSubmit(transfer_queue, 1, &submit_info, pending.fence.Get());
+        if (result != VK_SUCCESS) ThrowError("Failed to submit upload command buffer.", result);
+    }
+
+    pending.ticket = ++last_submitted;
+    in_flight_staging_bytes += pending.staging_bytes;
+    in_flight.push_back(std::move(pending));
+    pending.staging_bytes = 0;
+    recording = false;
+}
+
+void UploadQueue::CollectLocked()
+{
+    // Each submission finishes on the graphics queue in order, so only the oldest ones need to be checked
+    while (!in_flight.empty() && vkGetFenceStatus(device, in_flight.front().fence.Get()) == VK_SUCCESS) {
+        Submission& s = in_flight.front();
+        last_completed = s.ticket;
+        for (auto& staging : s.staging) staging_pool.Release(std::move(staging));
+        s.staging.clear();
+        in_flight_staging_bytes -= s.staging_bytes;
+        s.staging_bytes = 0;
+        s.fence.Reset();
+        free_submissions.push_back(std::move(s));
+        in_flight.pop_front();
+    }
+}
+}
\ No newline at end of file
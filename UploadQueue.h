@@ -0,0 +1,203 @@
+#ifndef UPLOADQUEUE_H
+#define UPLOADQUEUE_H
+
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <concepts>
+#include "vulkan/vulkan.h"
+#include "Buffer.h"
+#include "CommandBuffer.h"
+#include "CommandPool.h"
+#include "Concurrency.h"
+#include "StagingPool.h"
+
+namespace VKKit {
+class MemoryAllocator;
+
+// Collects transfer commands (buffer copies, image uploads) into one command buffer, which is submitted on Flush() with a fence instead
+// of waiting for the queue to go idle. Every recording function returns a ticket which can be waited on if the caller needs the upload to
+// be finished on the GPU.
+//
+// Copies run on the device's transfer queue. When that is a separate family from graphics, each flush also submits a small graphics
+// command buffer which waits for the copies, acquires ownership of the uploaded resources and runs the commands that need a graphics
+// queue (such as mipmap blits). Either way, uploads are finished with a memory barrier on the graphics queue, so work submitted to it
+// after the flush sees the data without waiting.
+//
+// Once a buffer has been handed to the graphics queue, frames may be reading it, so later copies to it are recorded on the graphics side
+// after a barrier instead. They then wait for the frames submitted before them and need no ownership transfer back to the transfer queue.
+//
+// Staging buffers return to the pool when the submission that used them completes. So that loading many assets outside the frame loop
+// doesn't hold on to all of their staging memory at once, AcquireStaging() collects the finished submissions, submits the pending
+// commands once their staging buffers pass a threshold, and waits for the oldest submission when too much staging memory is in flight.
+//
+// The recording functions are thread safe. Flush(), Wait() and AcquireStaging() submit to the graphics queue, so they must not run
+// concurrently with other submissions to it.
+class UploadQueue {
+public:
+    using Ticket = uint64_t;
+
+    // AcquireStaging() submits the pending commands once their staging buffers are this big, or there are this many of them
+    static constexpr VkDeviceSize MAX_PENDING_STAGING_BYTES = 32ull * 1024 * 1024;
+    static constexpr size_t MAX_PENDING_STAGING_BUFFERS = 256;
+
+    // AcquireStaging() waits for the oldest submissions while their staging buffers are bigger than this
+    static constexpr VkDeviceSize MAX_IN_FLIGHT_STAGING_BYTES = 128ull * 1024 * 1024;
+
+    /**
+     * @brief Construct an upload queue
+     *
+     * @param device The logical device used
+     * @param allocator The allocator the staging buffers will be allocated from
+     * @param transfer_family The queue family of transfer_queue
+     * @param transfer_queue The queue the copies will be submitted to
+     * @param graphics_family The queue family of graphics_queue
+     * @param graphics_queue The queue the uploaded resources will be used on. May be the same as transfer_queue.
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    UploadQueue(VkDevice device, MemoryAllocator& allocator, uint32_t transfer_family, VkQueue transfer_queue, uint32_t graphics_family,
+        VkQueue graphics_queue);
+
+    // Waits for all submitted uploads to finish. Uploads which haven't been flushed are discarded.
+    ~UploadQueue();
+
+    UploadQueue(const UploadQueue&) = delete;
+    UploadQueue& operator=(const UploadQueue&) = delete;
+    UploadQueue(UploadQueue&&) = delete;
+    UploadQueue& operator=(UploadQueue&&) = delete;
+
+    /**
+     * @brief Get a mapped staging buffer of at least size bytes from the upload queue's staging pool. Pass it to Record() or
+     *        RecordGraphics() and it goes back to the pool once the commands have finished executing. May flush the pending commands
+     *        and wait for earlier submissions first, see the class description.
+     * @throw std::runtime_error with error information on failure
+     */
+    Buffer AcquireStaging(VkDeviceSize size);
+
+    StagingPool& GetStagingPool() noexcept { return staging_pool; }
+
+    /**
+     * @brief Copy data to a buffer through a staging buffer owned by the upload queue. Ownership of dst is handed to the graphics queue.
+     *        If it was handed over before, the copy runs on the graphics side instead.
+     * @param dst The buffer to write to. It must have been created with VK_BUFFER_USAGE_TRANSFER_DST_BIT. A buffer the graphics queue
+     *        used without it going through the upload queue first has to be written with RecordGraphics() instead.
+     * @param data The data to copy
+     * @param size The size of the data
+     * @param dst_offset Where in dst to write the data
+     * @return The ticket of the upload
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    Ticket Upload(const Buffer& dst, const void* data, VkDeviceSize size, VkDeviceSize dst_offset = 0);
+
+    /**
+     * @brief Copy from one buffer to another. src must be kept alive until the returned ticket is complete. Ownership of dst is handed to
+     *        the graphics queue, like with Upload().
+     * @return The ticket of the copy
+     */
+    Ticket CopyBuffer(const Buffer& dst, const Buffer& src, VkDeviceSize size, VkDeviceSize dst_offset = 0, VkDeviceSize src_offset = 0);
+
+    /**
+     * @brief Record custom transfer commands (such as image copies and layout transitions) to the transfer queue. Resources written by
+     *        them have to be handed to the graphics queue with TransferOwnership().
+     * @param commands Called with the command buffer to record to
+     * @param staging A buffer from AcquireStaging() which will be kept alive until the commands have finished executing, then returned
+     *        to the staging pool
+     * @return The ticket of the commands
+     */
+    template<std::invocable<VkCommandBuffer> Commands>
+    Ticket Record(Commands&& commands, Buffer&& staging = Buffer())
+    {
+        std::scoped_lock lock(mutex);
+        commands(GetCommandBuffer());
+        AddStagingLocked(std::move(staging));
+        return last_submitted + 1;
+    }
+
+    /**
+     * @brief Record commands which need a graphics queue (such as blits, or copies that must be ordered after earlier frames). They run
+     *        after every transfer command recorded before them.
+     * @param commands Called with the command buffer to record to
+     * @param staging A buffer from AcquireStaging() which will be kept alive until the commands have finished executing, then returned
+     *        to the staging pool
+     * @return The ticket of the commands
+     */
+    template<std::invocable<VkCommandBuffer> Commands>
+    Ticket RecordGraphics(Commands&& commands, Buffer&& staging = Buffer())
+    {
+        std::scoped_lock lock(mutex);
+        GetCommandBuffer();
+        commands(pending.graphics_command_buffer.GetBuffer() ? pending.graphics_command_buffer.GetBuffer() : pending.command_buffer.GetBuffer());
+        AddStagingLocked(std::move(staging));
+        return last_submitted + 1;
+    }
+
+    // Hand a buffer written by the transfer queue over to the graphics queue. Only the first hand over of a buffer transfers ownership if
+    // they are different families, later copies to it through Upload() and CopyBuffer() run on the graphics side.
+    void TransferOwnership(const Buffer& buffer);
+
+    // Hand an image written by the transfer queue over to the graphics queue, keeping its layout. Does nothing if they are the same family.
+    void TransferOwnership(VkImage image, VkImageLayout layout, const VkImageSubresourceRange& range);
+
+    // Do the uploads run on a different queue family than graphics?
+    bool HasDedicatedTransferQueue() const noexcept { return transfer_family != graphics_family; }
+
+    /**
+     * @brief Submit all the commands recorded since the last flush
+     * @return The ticket of the submission. If nothing was recorded, the ticket of the previous submission.
+     *
+     * @throw std::runtime_error with error information on failure
+     */
+    Ticket Flush();
+
+    // Return the staging buffers of every submission that has finished executing to the staging pool
+    void Collect();
+
+    // Is the work with this ticket finished on the GPU?
+    bool IsComplete(Ticket ticket);
+
+    /**
+     * @brief Wait until the work with this ticket has finished executing, flushing first if it hasn't been submitted yet
+     * @throw std::runtime_error with error information if flushing fails
+     */
+    void Wait(Ticket ticket);
+
+private:
+    struct Submission {
+        CommandBuffer command_buffer;          // Runs on the transfer queue
+        CommandBuffer graphics_command_buffer; // Runs on the graphics queue, only used with a dedicated transfer queue
+        Semaphore transferred;                 // Signalled by command_buffer, waited on by graphics_command_buffer
+        Fence fence;
+        std::vector<Buffer> staging;
+        VkDeviceSize staging_bytes;            // The total size of staging
+        Ticket ticket;
+    };
+
+    VkDevice device;
+    MemoryAllocator* allocator;
+    uint32_t transfer_family, graphics_family;
+    VkQueue transfer_queue, graphics_queue;
+    CommandPool transfer_pool, graphics_pool;
+    StagingPool staging_pool; // Declared before the submissions, so it outlives the staging buffers they hold
+
+    Submission pending;
+    bool recording;
+    std::deque<Submission> in_flight;
+    std::vector<Submission> free_submissions;
+    Ticket last_submitted;
+    Ticket last_completed;
+    VkDeviceSize in_flight_staging_bytes; // The total size of the staging buffers of in_flight
+
+    std::mutex mutex;
+
+    VkCommandBuffer GetCommandBuffer();
+    void AddStagingLocked(Buffer&& staging);
+    void CopyBufferLocked(const Buffer& dst, VkBuffer src, const VkBufferCopy& region);
+    void TransferOwnershipLocked(const Buffer& buffer);
+    void FlushLocked();
+    void CollectLocked();
+};
+}
+
+#endif
\ No newline at end of file